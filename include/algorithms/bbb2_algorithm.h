@@ -2,87 +2,205 @@
 #define BBB2_ALGORITHM_H
 
 #include <vector>
-#include <map>
 #include <optional>
-#include <algorithm>
-#include <queue>
-#include <set>
-#include <iostream>
-#include <cmath>
+#include <cstdint>
 #include <limits>
-#include <string>
-#include <sstream>
-#include <unordered_set>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
 
 #include "bbb_algorithm.h"
+#include "../distance_multiset.h"
+#include "solution_enumeration.h"
+#include "../search_budget.h"
 
-class MultisetD {
-private:
-    std::map<int,int> counts;
-public:
-    void add(int value) {
-        counts[value]++;
-    }
-    void remove(int value) {
-        auto it = counts.find(value);
-        if (it != counts.end()) {
-            if (--it->second == 0) {
-                counts.erase(it);
-            }
-        }
-    }
-    bool contains(int value, int cnt=1) const {
-        auto it = counts.find(value);
-        return (it != counts.end() && it->second >= cnt);
-    }
-    bool empty() const {
-        return counts.empty();
-    }
-    std::vector<int> toVector() const {
-        std::vector<int> result;
-        result.reserve(256);
-        for (auto &kv : counts) {
-            for(int i = 0; i < kv.second; i++) {
-                result.push_back(kv.first);
-            }
-        }
-        return result;
-    }
-    static MultisetD fromVector(const std::vector<int>& vec){
-        MultisetD ms;
-        for (int x : vec) {
-            ms.add(x);
-        }
-        return ms;
-    }
-};
+class WorkStealingPool;
 
+/**
+ * BBb2Algorithm - breadth-first search down to an alpha level, then one BBb
+ * search per surviving alpha node. With more than one thread the alpha nodes
+ * are shared out to a pool, each worker finishing them on its own BBb solver;
+ * a validated map cancels the searches that can no longer win.
+ * Self-mirror states only take the y branch and states whose mirror image
+ * was already seen are dropped (see Symmetry).
+ */
 class BBb2Algorithm {
 public:
-    BBb2Algorithm() = default;
+    // Which map a multi-threaded solve returns when several alpha nodes have one.
+    enum class SolutionPolicy {
+        LOWEST_INDEX,   // the one the serial run finds, in alpha node order
+        FIRST_FOUND     // whichever is validated first
+    };
+
+    // When the breadth-first phase hands over to per-node search. A level is
+    // expanded while it is narrower than nodesPerThread per worker, or while
+    // at least dedupContinue of the last level's children were duplicates;
+    // never when the projected next level would exceed the frontier target,
+    // or when the next level at its largest would exceed the budget's cap.
+    struct AlphaCutoff {
+        size_t nodesPerThread{64};
+        double dedupContinue{0.5};
+        size_t maxFrontierBytes{64u << 20};   // 0 = only the budget's cap
+    };
+
+    // Cached per alpha node when the breadth-first phase ends.
+    struct AlphaMetrics {
+        int remaining{};      // distances still to place
+        int maxDistance{};    // the largest of them, placed next
+        int openBranches{};   // placements of maxDistance (0-2) that fit right now
+    };
+    // Strict weak order on alpha nodes; those ordered first are finished first.
+    using AlphaPriority = std::function<bool(const AlphaMetrics&, const AlphaMetrics&)>;
+    // Default priority: smallest subproblem, then the most forced next placement.
+    static bool easiestFirst(const AlphaMetrics& a, const AlphaMetrics& b);
+
+    BBb2Algorithm();
+    ~BBb2Algorithm();
     std::optional<std::vector<int>> solve(std::vector<int> D);
+    SolveResult solve(std::vector<int> D, const SearchBudget& budget);
+    EnumerationResult enumerate(std::vector<int> D,
+                                SolutionCallback onSolution,
+                                const EnumerationOptions& options = {});
+    // Breadth-first phase rooted at a partial map: sorted points ending at
+    // the width and the distances they do not account for.
+    SolveResult solvePartial(const std::vector<int>& placed,
+                             const DistanceMultiset& remaining,
+                             const SearchBudget& budget);
+
+    // Also used by the BBb solver that finishes each alpha node.
+    void setThreadCount(int threads);
+    void setSolutionPolicy(SolutionPolicy policy) { solutionPolicy = policy; }
+    void setAlphaCutoff(const AlphaCutoff& cutoff) { alphaCutoff = cutoff; }
+    void setAlphaPriority(AlphaPriority priority) { alphaPriority = std::move(priority); }
+    // Depth at which the last solve stopped breadth-first expansion.
+    int lastAlphaDepth() const { return alphaDepth; }
+    // Confirms every visited-state hash match by comparing the states themselves.
+    void setVerifyStates(bool verify) { verifyStates = verify; }
+    // Hash matches between different states seen by the last solve in verify mode.
+    size_t hashCollisions() const { return visited.collisions(); }
 
 private:
     BBbAlgorithm bbbSolver;
     std::vector<int> originalDistances;
+    int threadCount{1};
+    SolutionPolicy solutionPolicy{SolutionPolicy::LOWEST_INDEX};
+    AlphaCutoff alphaCutoff;
+    AlphaPriority alphaPriority{easiestFirst};
+    int alphaDepth{};
+    std::unique_ptr<WorkStealingPool> pool;
+    std::vector<std::unique_ptr<BBbAlgorithm>> alphaSolvers;
+
+    // 128-bit state hash: XOR of point keys plus the sum of distance keys,
+    // both updated per placement without looking at the rest of the state.
+    struct StateKey {
+        uint64_t points{};
+        uint64_t distances{};
+        bool operator==(const StateKey& other) const {
+            return points == other.points && distances == other.distances;
+        }
+    };
 
     struct AlphaNode {
-        MultisetD D;
+        DistanceMultiset D;
         std::vector<int> X;
-        AlphaNode(MultisetD d, std::vector<int> x) 
-            : D(std::move(d)), X(std::move(x)) {}
+        StateKey key;
+        AlphaMetrics metrics;
+        AlphaNode(DistanceMultiset d, std::vector<int> x, StateKey k)
+            : D(std::move(d)), X(std::move(x)), key(k) {}
+    };
+
+    /**
+     * VisitedStates - open-addressing set of state hashes. In verify mode it
+     * keeps a copy of every state and treats a hash match as a hit only when
+     * the states are equal.
+     */
+    class VisitedStates {
+    public:
+        void reset(bool verify);
+        bool contains(const StateKey& key) const;
+        // The mirror image of node's state was already inserted.
+        bool containsMirror(const AlphaNode& node) const;
+        // False if the state was already present.
+        bool insert(const AlphaNode& node);
+        size_t collisions() const { return collisionCount; }
+        size_t memoryBytes() const {
+            return table.capacity() * sizeof(int) + keys.capacity() * sizeof(StateKey)
+                 + states.capacity() * sizeof(AlphaNode);
+        }
+        // Upper bound on memoryBytes() once added more states are inserted.
+        size_t memoryBytesAfter(size_t added) const;
+
+    private:
+        bool verify{};
+        std::vector<int> table;     // index into keys, -1 when free
+        size_t mask{};
+        std::vector<StateKey> keys;
+        std::vector<AlphaNode> states;
+        size_t collisionCount{};
+
+        static size_t bucketOf(const StateKey& key) {
+            return static_cast<size_t>(key.points ^ (key.distances * 0x9E3779B97F4A7C15ULL));
+        }
+        void grow();
     };
 
-    void buildToAlpha(std::vector<AlphaNode>& alphaNodes,
-                      const std::vector<int>& initialD,
+    bool verifyStates{false};
+    VisitedStates visited;
+
+    SolveResult solveFrom(const std::vector<int>& X0, const DistanceMultiset& D, BudgetGuard& guard);
+    std::vector<AlphaNode> prepareAlphaNodes(const std::vector<int>& X0,
+                                             const DistanceMultiset& D,
+                                             BudgetGuard& guard);
+    bool buildToAlpha(std::vector<AlphaNode>& alphaNodes,
+                      const DistanceMultiset& initialD,
                       const std::vector<int>& initialX,
-                      int alpha);
+                      BudgetGuard& guard);
+    bool shouldDeepen(const std::vector<AlphaNode>& level,
+                      double branching,
+                      double dedupRate,
+                      size_t frontierBytes,
+                      const BudgetGuard& guard) const;
+    static size_t nodeBytes(const AlphaNode& node);
+    AlphaMetrics measure(AlphaNode& node);
+    static StateKey rootKey(const DistanceMultiset& D, const std::vector<int>& X);
+    void expandAlphaNode(const AlphaNode& current, std::vector<AlphaNode>& out);
+    void addCandidate(const AlphaNode& current, int y, std::vector<AlphaNode>& out);
+    bool expandLevelParallel(const std::vector<AlphaNode>& level,
+                             std::vector<AlphaNode>& candidates,
+                             BudgetGuard& guard);
+
+    // The alpha node each worker is finishing and the flag that cancels it.
+    struct AlphaSlot {
+        std::atomic<size_t> node{0};
+        std::atomic<bool> stop{false};
+    };
+
+    struct AlphaContext {
+        const std::vector<AlphaNode>* nodes{};
+        BudgetGuard* guard{};
+        std::vector<AlphaSlot> slots;
+        std::atomic<size_t> nextNode{0};
+        std::atomic<size_t> bestNode{std::numeric_limits<size_t>::max()};
+        std::mutex solutionMutex;
+        std::optional<std::vector<int>> solution;
+
+        explicit AlphaContext(size_t workers) : slots(workers) {}
+    };
+
+    std::optional<std::vector<int>> solveAlphaNodes(const std::vector<AlphaNode>& alphaNodes,
+                                                    BudgetGuard& guard);
+    std::optional<std::vector<int>> solveAlphaNodesParallel(const std::vector<AlphaNode>& alphaNodes,
+                                                            BudgetGuard& guard);
+    void runAlphaWorker(AlphaContext& ctx, size_t worker);
+    bool alphaNodeCanWin(const AlphaContext& ctx, size_t index) const;
+    void recordAlphaSolution(AlphaContext& ctx, size_t index, std::vector<int> X);
 
-    std::optional<std::vector<int>> processAlphaNode(const AlphaNode& node);
+    std::optional<std::vector<int>> processAlphaNode(const AlphaNode& node,
+                                                     BBbAlgorithm& solver,
+                                                     BudgetGuard& guard,
+                                                     const std::atomic<bool>* stop = nullptr);
     bool isValidSolution(const std::vector<int>& X, const std::vector<int>& origD) const;
-    bool removeDelta(MultisetD &mD, int y, const std::vector<int>& X);
-    int calculateN(int setSize) const;
-    int findAlphaM(int N) const;
 };
 
 #endif // BBB2_ALGORITHM_H
@@ -5,22 +5,122 @@
 #include <optional>
 #include <algorithm>
 #include <set>
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include <atomic>
 
+#include "../distance_multiset.h"
+#include "bbb_frontier.h"
+#include "bbd_search.h"
+#include "solution_enumeration.h"
+#include "../search_budget.h"
+
+class WorkStealingPool;
+
+/**
+ * BBbAlgorithm - breadth-first branch and bound over flat frontier arenas.
+ * With more than one thread, levels of at least PARALLEL_LEVEL_MIN nodes are
+ * split into contiguous chunks expanded on a work-stealing pool, deduplicated
+ * across chunks by fingerprint shard and merged back in serial order.
+ * Self-mirror nodes only take the y branch and a child whose mirror image
+ * is already on the level is dropped (see Symmetry).
+ * Under a memory ceiling, a level that might not fit is not built: each node
+ * of the current level is finished by depth-first search instead.
+ */
 class BBbAlgorithm {
 public:
-    BBbAlgorithm() = default;
+    static constexpr size_t PARALLEL_LEVEL_MIN = 1024;
+
+    BBbAlgorithm();
+    ~BBbAlgorithm();
     std::optional<std::vector<int>> solve(std::vector<int> D);
+    SolveResult solve(std::vector<int> D, const SearchBudget& budget);
     std::optional<std::vector<int>> solvePartial(const std::vector<int>& partialX,
                                                  std::vector<int> leftoverD);
+    std::optional<std::vector<int>> solvePartial(const std::vector<int>& partialX,
+                                                 std::vector<int> leftoverD,
+                                                 BudgetGuard& guard);
+    // Takes the caller's multiset as the root state without converting it.
+    // Gives up with no result once stop is raised.
+    std::optional<std::vector<int>> solvePartial(const std::vector<int>& partialX,
+                                                 const DistanceMultiset& leftoverD,
+                                                 BudgetGuard& guard,
+                                                 const std::atomic<bool>* stop = nullptr);
+    // Streams every completion of partialX; returns false if stopped early.
+    bool enumeratePartial(const std::vector<int>& partialX,
+                          std::vector<int> leftoverD,
+                          const SolutionCallback& onSolution,
+                          const std::function<bool()>& shouldStop);
+    bool enumeratePartial(const std::vector<int>& partialX,
+                          const DistanceMultiset& leftoverD,
+                          const SolutionCallback& onSolution,
+                          const std::function<bool()>& shouldStop);
+
+    void setThreadCount(int threads);
+    // Frontier ceiling in bytes, 0 for none; a budget's memory cap also applies.
+    void setMemoryLimit(size_t bytes) { memoryLimit = bytes; }
+    // Keeps dead children out of the frontier with a one-step lookahead
+    // (see Lookahead); also applies to the depth-first fallback.
+    void setLookahead(bool enabled) {
+        lookahead = enabled;
+        depthFirst.setLookahead(enabled);
+    }
+
 private:
-    std::vector<int> calculateDelta(int y, const std::vector<int>& X);
-    bool isSubset(const std::vector<int>& subset, const std::vector<int>& set);
-    std::vector<int> removeSubset(const std::vector<int>& set, const std::vector<int>& subset);
-    void generateNextLevel(std::vector<std::vector<int>>& LD,
-                           std::vector<std::vector<int>>& LX);
-    void generateNextLevelPartial(std::vector<std::vector<int>>& LD,
-                                  std::vector<std::vector<int>>& LX,
-                                  int width);
+    // The one fully materialized node a thread works on.
+    struct Scratch {
+        DistanceMultiset D;
+        std::vector<int> X;
+        uint64_t hash{};
+        std::vector<int> dropped;
+        std::vector<int> added;
+    };
+
+    struct ExpansionChunk {
+        size_t begin{};
+        size_t end{};
+        Scratch work;
+        BBbFrontier children;
+        std::vector<uint8_t> keep;
+        size_t rowBase{};
+        size_t pointBase{};
+    };
+
+    // Two levels of the BFS; swapped after each expansion and reused across solves.
+    BBbFrontier current;
+    BBbFrontier next;
+    Scratch scratch;
+    size_t memoryLimit{};
+    bool lookahead{false};
+    BBdSearch depthFirst;
+    const std::atomic<bool>* stopFlag{};
+    // Enumeration's stop condition, polled per expanded node like stopFlag
+    // and per CHECK_INTERVAL slice in the depth-first fallback.
+    const std::function<bool()>* stopCheck{};
+
+    int threadCount{1};
+    std::unique_ptr<WorkStealingPool> pool;
+    std::vector<ExpansionChunk> chunks;
+    std::vector<std::vector<uint64_t>> shards;
+
+    bool stopped() const {
+        return (stopFlag && stopFlag->load(std::memory_order_relaxed)) || (stopCheck && (*stopCheck)());
+    }
+    size_t memoryCeiling(const BudgetGuard& guard) const;
+    bool nextLevelFits(size_t ceiling) const;
+    size_t chunkCountFor(size_t rows) const;
+    size_t chunkScratchBytes(size_t chunkCount) const;
+    size_t depthFirstBytes() const;
+    bool searchDepthFirst(BudgetGuard& guard, const SolutionCallback& onSolution);
+    void seedFrontier(DistanceMultiset root, const std::vector<int>& X);
+    void materialize(size_t row, Scratch& work) const;
+    void addChild(Scratch& work, int y, BBbFrontier& out);
+    void expandNode(size_t row, int width, Scratch& work, BBbFrontier& out);
+    bool generateNextLevel(int width, BudgetGuard& guard);
+    bool generateNextLevelParallel(int width, BudgetGuard& guard);
+    void dedupShard(size_t shard, size_t shardCount, size_t chunkCount);
+    void dropMirrors(size_t chunk, size_t shardCount);
 };
 
 #endif //BBB_ALGORITHM_H
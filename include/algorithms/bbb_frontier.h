@@ -0,0 +1,65 @@
+#ifndef BBB_FRONTIER_H
+#define BBB_FRONTIER_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * BBbFrontier - one BFS level of BBb stored as structure-of-arrays.
+ * A node is only its sorted point set, kept in one arena addressed by offsets:
+ * the remaining distances follow from the points and the root, so the solver
+ * rebuilds them on demand instead of storing O(n^2) counts per node.
+ * reset() keeps the capacity, so two frontiers swapped between levels stop
+ * allocating once the widest level has been seen.
+ * Duplicate point sets are rejected through an open-addressing table keyed
+ * by each row's Zobrist fingerprint; rows are compared only on a hash match.
+ * A row whose mirror image is already on the level is rejected the same way.
+ */
+class BBbFrontier {
+public:
+    BBbFrontier() = default;
+
+    void reset();
+    void swap(BBbFrontier& other) noexcept;
+
+    size_t size() const { return remainingCounts.size(); }
+    bool empty() const { return remainingCounts.empty(); }
+
+    int remaining(size_t row) const { return remainingCounts[row]; }
+    const int* points(size_t row) const { return pointArena.data() + pointOffsets[row]; }
+    size_t pointCount(size_t row) const { return pointOffsets[row + 1] - pointOffsets[row]; }
+    std::vector<int> pointsOf(size_t row) const;
+    uint64_t fingerprint(size_t row) const { return fingerprints[row]; }
+
+    // remaining is the number of distances the node has left to place.
+    void push(const std::vector<int>& X, int remaining);
+    // Appends the sorted points X with y inserted in order, unless the level
+    // already holds that point set or its mirror. fingerprint must hash X plus y.
+    bool pushUnique(const std::vector<int>& X, int y, int remaining, uint64_t fingerprint);
+
+    // Sizes the arenas for a level whose rows are then filled by setRow(),
+    // possibly from several threads; rows must be disjoint and fully written.
+    void prepareRows(size_t rows, size_t totalPoints);
+    void setRow(size_t row, size_t pointOffset, const BBbFrontier& source, size_t sourceRow);
+
+    size_t memoryBytes() const;
+
+private:
+    std::vector<int> remainingCounts;
+    std::vector<int> pointArena;
+    std::vector<size_t> pointOffsets{0};
+    std::vector<uint64_t> fingerprints;
+
+    std::vector<int> table;     // row index per bucket, -1 when free
+    size_t tableMask{};
+
+    void pushRow(const std::vector<int>& X, int y, int remaining);
+    void popBack();
+    bool samePoints(size_t a, size_t b) const;
+    // Another row holds the mirror image of row.
+    bool hasMirror(size_t row) const;
+    void growTable();
+};
+
+#endif // BBB_FRONTIER_H
@@ -5,27 +5,82 @@
 #include <optional>
 #include <algorithm>
 #include <cmath>
+#include <atomic>
+#include <mutex>
+#include <span>
 
+#include "bbd_search.h"
+#include "transposition_table.h"
+#include "solution_enumeration.h"
+#include "../search_budget.h"
 
+class WorkStealingPool;
+
+/**
+ * BBdAlgorithm - depth-first branch and bound.
+ * The whole search runs in place on a BBdSearch: one mutable distance multiset
+ * and point set, with each placement undone by restoring its distances.
+ * With more than one thread the branches near the root become tasks on a
+ * work-stealing pool and the first worker to find a map stops the others.
+ * An optional transposition table, shared by all workers, remembers states
+ * whose subtree was exhausted so other placement orders skip them.
+ */
 class BBdAlgorithm {
 public:
     BBdAlgorithm() = default;
     std::optional<std::vector<int>> solve(std::vector<int> D);
+    SolveResult solve(std::vector<int> D, const SearchBudget& budget);
+    EnumerationResult enumerate(std::vector<int> D,
+                                SolutionCallback onSolution,
+                                const EnumerationOptions& options = {});
+    // Continue from a partial map: sorted points ending at the width and the
+    // distances they do not account for.
+    SolveResult solvePartial(const std::vector<int>& placed,
+                             const DistanceMultiset& remaining,
+                             const SearchBudget& budget);
+    EnumerationResult enumeratePartial(const std::vector<int>& placed,
+                                       const DistanceMultiset& remaining,
+                                       SolutionCallback onSolution,
+                                       const EnumerationOptions& options = {});
+
+    void setThreadCount(int threads) { threadCount = std::max(1, threads); }
+    // Depth up to which branches are turned into tasks; 0 picks one from the thread count.
+    void setSplitDepth(int depth) { splitDepth = std::max(0, depth); }
+    // One-step lookahead after every placement (see Lookahead).
+    void setLookahead(bool enabled) { lookahead = enabled; }
+    // Memory for the table of states proven dead (see TranspositionTable); 0 turns it off.
+    void setTranspositionTableBytes(size_t bytes) { transpositions.configure(bytes); }
 
 private:
-    struct Node {
-        std::vector<int> D;
-        std::vector<int> X;
-        int level;
-        Node(const std::vector<int>& d, const std::vector<int>& x, int lvl)
-            : D(d), X(x), level(lvl) {}
+    // Nodes expanded between time-limit checks while enumerating.
+    static constexpr uint64_t ENUMERATION_CHECK_INTERVAL = 4096;
+
+    struct ParallelContext {
+        WorkStealingPool* pool{};
+        BudgetGuard* guard{};
+        std::vector<BBdSearch> workerSearch;
+        int splitDepth{};
+        std::atomic<bool> found{false};
+        std::mutex solutionMutex;
+        std::optional<std::vector<int>> solution;
     };
 
-    std::vector<int> calculateDelta(int y, const std::vector<int>& X);
-    bool isSubset(const std::vector<int>& subset, const std::vector<int>& set);
-    std::vector<int> removeSubset(const std::vector<int>& set, const std::vector<int>& subset);
+    int threadCount{1};
+    int splitDepth{0};
+    bool lookahead{false};
+    TranspositionTable transpositions;
+    BBdSearch search;
 
-    std::optional<std::vector<int>> place(Node& current);
+    // Both run the search already built or seeded in search.
+    SolveResult solveLoaded(BudgetGuard& guard);
+    EnumerationResult enumerateLoaded(SolutionSink& sink);
+    SolveResult solveParallel(BudgetGuard& guard);
+    void runTask(ParallelContext& ctx, const std::vector<int>& prefix);
+    void recordSolution(ParallelContext& ctx, const BBdSearch& worker);
+    void prepare(BBdSearch& root);
+    // Sums the table lookups of searches into the result.
+    static SolveResult finish(const BudgetGuard& guard, std::optional<std::vector<int>> solution,
+                              std::span<const BBdSearch> searches);
 };
 
 #endif // BBD_ALGORITHM_H
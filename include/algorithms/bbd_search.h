@@ -0,0 +1,130 @@
+#ifndef BBD_SEARCH_H
+#define BBD_SEARCH_H
+
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <limits>
+
+#include "../distance_multiset.h"
+#include "../search_budget.h"
+#include "transposition_table.h"
+
+/**
+ * BBdSearch - iterative BBd driver over an explicit, preallocated frame stack.
+ * One frame per placement holds the point and the branch taken; popping it
+ * gives back the distances from that point to the ones placed before it, so
+ * a search can be paused after any number of nodes, inspected and resumed.
+ * Nodes are visited in the same order as the recursive formulation, except
+ * that the complement branch of a self-mirror map is never taken.
+ */
+class BBdSearch {
+public:
+    enum class Status {
+        READY,
+        PAUSED,
+        FOUND,
+        EXHAUSTED,
+        STOPPED
+    };
+
+    enum class Branch : uint8_t {
+        DISTANCE,     // placed y, the largest remaining distance
+        COMPLEMENT,   // placed width - y
+        FIXED         // placed by the caller, never revisited
+    };
+
+    struct Frame {
+        int y;
+        Branch branch;
+    };
+
+    BBdSearch() = default;
+    explicit BBdSearch(std::vector<int> D);
+    void build(const std::vector<int>& distances, int totalWidth);
+    // Starts from a partial map: sorted points ending at the width and the
+    // distances they have not consumed yet.
+    void seed(const DistanceMultiset& remaining, const std::vector<int>& placed);
+
+    // Placements made outside run() become the fixed root of the next search.
+    bool applyPlacement(int y);
+    void undoPlacement();
+    void rewind();
+
+    Status run(uint64_t maxNodes = std::numeric_limits<uint64_t>::max(),
+               const std::atomic<bool>* stop = nullptr);
+    // Runs in CHECK_INTERVAL slices charged to guard until a map is found;
+    // false once the tree is exhausted, stop is raised, shouldStop returns
+    // true after a slice or the budget runs out.
+    bool runWithin(BudgetGuard& guard, const std::atomic<bool>* stop = nullptr,
+                   const std::function<bool()>* shouldStop = nullptr);
+
+    // Rejects placements after which the next distance fits on neither side.
+    void setLookahead(bool enabled) { lookahead = enabled; }
+    // Records exhausted states in table and skips them when reached again;
+    // the table may be shared by several searches over the same distances.
+    // The state hashes are only maintained while a table is set.
+    void setTranspositionTable(TranspositionTable* shared) {
+        table = shared;
+        if (table) {
+            hashPoints();
+        }
+    }
+
+    Status status() const { return currentStatus; }
+    bool done() const { return remainingD.empty(); }
+    int nextDistance() const { return remainingD.max(); }
+    int getWidth() const { return width; }
+    int depth() const { return static_cast<int>(frames.size()); }
+    // Placed points equal their mirror image, so the complement branch is skipped.
+    bool selfMirror() const { return unmatchedPoints == 0; }
+    uint64_t nodesExpanded() const { return nodes; }
+    // Table lookups made by this search, counted here so workers sharing
+    // a table do not contend on one counter.
+    uint64_t tableHits() const { return hits; }
+    uint64_t tableMisses() const { return misses; }
+    const std::vector<int>& points() const { return X; }
+    const std::vector<Frame>& getFrames() const { return frames; }
+    const DistanceMultiset& remaining() const { return remainingD; }
+    std::vector<int> sortedPoints() const;
+    size_t memoryBytes() const;
+
+private:
+    DistanceMultiset remainingD;
+    int width{};
+
+    std::vector<int> X;          // placed points in placement order
+    std::vector<Frame> frames;
+    size_t baseDepth{};
+    std::vector<uint64_t> placedBits;  // bit x is set while point x is placed
+    int unmatchedPoints{};       // placed points whose mirror is not placed
+    bool lookahead{false};
+
+    // Zobrist hashes of the placed points and of their mirror image; the
+    // smaller one keys the state, since a map is dead exactly when its mirror is.
+    uint64_t pointsHash{};
+    uint64_t mirrorHash{};
+    TranspositionTable* table{};
+    size_t solvedDepth{};        // frames below this have a solution in their subtree
+    uint64_t nodes{};
+    uint64_t hits{};
+    uint64_t misses{};
+    Status currentStatus{Status::READY};
+
+    void reserveFor(size_t distances);
+    void markPoints();
+    void hashPoints();
+    bool placed(int x) const { return (placedBits[static_cast<size_t>(x) / 64] >> (x % 64)) & 1; }
+    void flipPlaced(int x) { placedBits[static_cast<size_t>(x) / 64] ^= 1ULL << (x % 64); }
+    // Change in unmatchedPoints when y is placed, given the points placed before it.
+    int unmatchedDelta(int y) const {
+        int mirror = width - y;
+        return mirror == y ? 0 : (placed(mirror) ? -1 : 1);
+    }
+    bool push(int y, Branch branch);
+    void pop();
+    bool backtrack();
+};
+
+#endif // BBD_SEARCH_H
@@ -0,0 +1,48 @@
+#ifndef LOOKAHEAD_H
+#define LOOKAHEAD_H
+
+#include <cstddef>
+#include <cstdlib>
+
+#include "../distance_multiset.h"
+
+/**
+ * Lookahead - one-step feasibility test run right after a placement.
+ * The next distance to place is the largest one left, and it must go either
+ * at y or at width - y. If neither position fits the updated multiset, the
+ * node is dead, and rejecting it here saves a recursion or a frontier row.
+ * D is modified during the test and restored before returning.
+ */
+namespace Lookahead {
+    // Every distance from y to points plus extra is still in D, with multiplicity.
+    inline bool fits(DistanceMultiset& D, int y, const int* points, size_t count, int extra) {
+        if (!D.remove(std::abs(y - extra))) {
+            return false;
+        }
+        bool ok = D.removeDeltas(y, points, count);
+        if (ok) {
+            D.restoreDeltas(y, points, count);
+        }
+        D.restore(std::abs(y - extra));
+        return ok;
+    }
+
+    // D is what is left after placing newPoint next to points.
+    inline bool nextPlacementPossible(DistanceMultiset& D, const int* points, size_t count,
+                                      int newPoint, int width) {
+        if (D.empty()) {
+            return true;
+        }
+        // The next placement consumes one distance per point already placed.
+        if (static_cast<size_t>(D.size()) < count + 1) {
+            return false;
+        }
+        int y = D.max();
+        if (fits(D, y, points, count, newPoint)) {
+            return true;
+        }
+        return width - y != y && fits(D, width - y, points, count, newPoint);
+    }
+}
+
+#endif // LOOKAHEAD_H
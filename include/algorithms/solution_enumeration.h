@@ -0,0 +1,48 @@
+#ifndef SOLUTION_ENUMERATION_H
+#define SOLUTION_ENUMERATION_H
+
+#include <vector>
+#include <set>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+
+// Receives each distinct map as soon as it is found; return false to stop.
+using SolutionCallback = std::function<bool(const std::vector<int>&)>;
+
+struct EnumerationOptions {
+    size_t maxSolutions{0};                 // 0 = no limit
+    std::chrono::milliseconds timeLimit{0}; // 0 = no limit
+};
+
+struct EnumerationResult {
+    size_t solutionCount{};
+    bool complete{};   // false if stopped by a limit or by the callback
+};
+
+/**
+ * SolutionSink - forwards enumerated maps to the callback.
+ * A map and its mirror image (width - x) produce the same distances, so only
+ * the first orientation seen is reported. Also enforces the limits.
+ */
+class SolutionSink {
+public:
+    SolutionSink(SolutionCallback callback, const EnumerationOptions& options);
+
+    // Returns false once enumeration should stop.
+    bool offer(const std::vector<int>& sortedPoints);
+    bool shouldStop() const;
+    EnumerationResult finish(bool exhausted) const;
+
+private:
+    SolutionCallback onSolution;
+    EnumerationOptions limits;
+    std::chrono::steady_clock::time_point deadline;
+    std::set<std::vector<int>> seen;
+    size_t reported{};
+    bool stopped{};
+
+    static std::vector<int> canonical(const std::vector<int>& sortedPoints);
+};
+
+#endif // SOLUTION_ENUMERATION_H
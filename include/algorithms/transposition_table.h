@@ -0,0 +1,49 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * TranspositionTable - bounded, lock-free set of state hashes proven dead.
+ * Buckets of BUCKET_SLOTS 64-bit entries; the low bit of an entry is its
+ * reference bit, set on every hit. A full bucket is cleaned clock-style:
+ * referenced entries get a second chance, the first unreferenced one is
+ * overwritten. Lost races only drop an entry, which costs a re-search.
+ * Entries are 63-bit tags, not states: a live state whose key matches a dead
+ * one on those bits is pruned, which can lose a map or report none. With
+ * random 64-bit Zobrist keys that takes a collision of about 2^-61 per
+ * lookup, under 10^-6 over 10^12 lookups; solvers that must be exact leave
+ * the table off. Safe to share between threads.
+ */
+class TranspositionTable {
+public:
+    static constexpr size_t BUCKET_SLOTS = 4;
+
+    // Sizes the table to at most maxBytes and empties it; 0 disables it.
+    void configure(size_t maxBytes);
+    void clear();
+    bool enabled() const { return slots != nullptr; }
+
+    bool contains(uint64_t key);
+    void insert(uint64_t key);
+
+    size_t memoryBytes() const { return slotCount * sizeof(std::atomic<uint64_t>); }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    size_t slotCount{};
+    size_t bucketMask{};
+
+    static uint64_t tagOf(uint64_t key) {
+        uint64_t tag = key & ~1ULL;
+        return tag != 0 ? tag : 2;   // zero marks a free slot
+    }
+    std::atomic<uint64_t>* bucketOf(uint64_t key) const {
+        return slots.get() + (static_cast<size_t>(key >> 16) & bucketMask) * BUCKET_SLOTS;
+    }
+};
+
+#endif // TRANSPOSITION_TABLE_H
@@ -9,6 +9,9 @@
 #include <fstream>
 #include <iomanip>
 
+#include "distance_multiset.h"
+#include "search_budget.h"
+
 /**
  * DebugMapSolver is a variant of MapSolver with detailed logging of each step.
  * It can be used for education or in-depth debugging.
@@ -30,6 +33,7 @@ public:
                    const std::string& logPath = "debug_solver.log");
 
     std::optional<std::vector<int>> solve();
+    SolveResult solve(const SearchBudget& budget);
     const Statistics& getStatistics() const { return stats; }
 
 private:
@@ -38,7 +42,8 @@ private:
     int totalLength{};
     int maxind{};
     Statistics stats;
-    std::map<int, int> distanceCounter;
+    DistanceMultiset distanceCounter;
+    BudgetGuard* guard{};
 
     bool debugToFile;
     std::ofstream logFile;
@@ -47,6 +52,7 @@ private:
     std::map<int, int> bestDistanceUsage;
     std::vector<std::pair<int, std::vector<int>>> invalidationHistory;
 
+    size_t memoryBytes() const;
     void logMapState(const std::string& message);
     void logDistanceConstraints();
     std::string getIndentation() const;
@@ -0,0 +1,40 @@
+#ifndef DELTA_KERNEL_H
+#define DELTA_KERNEL_H
+
+#include <cstddef>
+
+#include "distance_multiset.h"
+
+/**
+ * DeltaKernel - vectorized removal of the deltas |y - x| of a placement.
+ * The AVX2 path computes 8 deltas per step, gathers their slots from the
+ * dense index and rejects the placement if any is out of range or absent;
+ * the slots are then decremented in order, which also catches a delta that
+ * repeats within the placement. Each delta is looked up once, as in the
+ * scalar loop of DistanceMultiset::removeDeltas, which is used instead when
+ * the CPU lacks AVX2 or a placement is too small to pay for the setup.
+ */
+namespace DeltaKernel {
+    enum class Mode {
+        AUTO,
+        SCALAR,
+        AVX2
+    };
+
+    // Below this many points the scalar loop is cheaper.
+    constexpr size_t MIN_BATCH = 16;
+
+    // Removes every |y - points[i]| from D, or none of them on failure.
+    bool removeDeltasAvx2(DistanceMultiset& D, int y, const int* points, size_t count);
+    // Puts back what a successful removeDeltasAvx2 took.
+    void restoreDeltasAvx2(DistanceMultiset& D, int y, const int* points, size_t count);
+    // Whether DistanceMultiset::removeDeltas goes through removeDeltasAvx2.
+    bool enabled();
+
+    bool avx2Supported();
+    // Forces a path for benchmarking; AVX2 falls back to scalar when unsupported.
+    void setMode(Mode mode);
+    Mode activeMode();
+}
+
+#endif // DELTA_KERNEL_H
@@ -0,0 +1,41 @@
+#ifndef DELTA_KERNEL_BENCHMARK_H
+#define DELTA_KERNEL_BENCHMARK_H
+
+#include <vector>
+#include <string>
+
+#include "delta_kernel.h"
+
+/**
+ * DeltaKernelBenchmark - scalar against AVX2 delta removal.
+ * For each map size every site is placed against all other sites and taken
+ * back again, so each placement succeeds and removes all n - 1 deltas. The
+ * map is then solved with BBd on each path to show the effect on the engine.
+ */
+class DeltaKernelBenchmark {
+public:
+    struct KernelResult {
+        int instanceSize;
+        double scalarNsPerPlacement;
+        double avx2NsPerPlacement;
+        double scalarSolveMs;
+        double avx2SolveMs;
+    };
+
+    explicit DeltaKernelBenchmark(std::vector<int> sizes = {30, 50, 100, 150, 200},
+                                  int placementsPerSize = 200000);
+    std::vector<KernelResult> run();
+    void printResults(const std::vector<KernelResult>& results) const;
+
+private:
+    std::vector<int> instanceSizes;
+    int placementCount;
+
+    double measurePlacements(DeltaKernel::Mode mode,
+                             DistanceMultiset D,
+                             const std::vector<std::vector<int>>& pointSets,
+                             const std::vector<int>& probes) const;
+    static double measureSolve(DeltaKernel::Mode mode, const std::vector<int>& distances);
+};
+
+#endif // DELTA_KERNEL_BENCHMARK_H
@@ -0,0 +1,95 @@
+#ifndef DISTANCE_MULTISET_H
+#define DISTANCE_MULTISET_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/**
+ * DistanceMultiset - multiset of distances stored as a dense count array.
+ * Distinct values are compressed to slots once; copies share the value index
+ * and only duplicate the count array. Contains/remove/restore are O(1) and the
+ * current maximum is tracked with a slot pointer that only moves on demand.
+ */
+class DistanceMultiset {
+public:
+    DistanceMultiset() = default;
+    explicit DistanceMultiset(const std::vector<int>& distances);
+    static DistanceMultiset fromVector(const std::vector<int>& distances);
+
+    int slotOf(int value) const {
+        return (value >= 0 && value < tableSize) ? slotTable[value] : -1;
+    }
+    bool containsSlot(int slot) const {
+        return slot >= 0 && counts[static_cast<size_t>(slot)] > 0;
+    }
+    bool removeSlot(int slot) {
+        if (!containsSlot(slot)) {
+            return false;
+        }
+        counts[static_cast<size_t>(slot)]--;
+        remaining--;
+        return true;
+    }
+    void restoreSlot(int slot) {
+        counts[static_cast<size_t>(slot)]++;
+        remaining++;
+        if (slot > topSlot) {
+            topSlot = slot;
+        }
+    }
+
+    // Removes one of each slot, or none if any of them runs out; a slot may repeat.
+    bool removeSlots(const int* slots, size_t count);
+    void restoreSlots(const int* slots, size_t count);
+
+    bool contains(int value, int cnt = 1) const;
+    int count(int value) const;
+    bool remove(int value) { return removeSlot(slotOf(value)); }
+    void restore(int value) { restoreSlot(slotOf(value)); }
+
+    // Removes |y - x| for every x in points: all of them, or none on failure.
+    bool removeDeltas(int y, const int* points, size_t count);
+    bool removeDeltas(int y, const std::vector<int>& points) {
+        return removeDeltas(y, points.data(), points.size());
+    }
+    // Puts back the distances a successful removeDeltas(y, points) took.
+    void restoreDeltas(int y, const int* points, size_t count);
+    void restoreDeltas(int y, const std::vector<int>& points) {
+        restoreDeltas(y, points.data(), points.size());
+    }
+
+    int max() const;
+    bool empty() const { return remaining == 0; }
+    int size() const { return remaining; }
+
+    int distinctCount() const { return static_cast<int>(counts.size()); }
+    int valueAt(int slot) const { return index->values[static_cast<size_t>(slot)]; }
+    int countAt(int slot) const { return counts[static_cast<size_t>(slot)]; }
+
+    std::vector<int> toVector() const;
+    bool operator==(const DistanceMultiset& other) const;
+    // Bytes owned by this copy; the shared value index is counted separately.
+    size_t memoryBytes() const { return counts.capacity() * sizeof(int); }
+    size_t indexMemoryBytes() const;
+
+    // Raw views for vectorized kernels.
+    const int* slotData() const { return slotTable; }
+    int slotTableSize() const { return tableSize; }
+
+private:
+    struct Index {
+        std::vector<int> values;   // distinct distances, ascending
+        std::vector<int> slotOf;   // distance -> slot, -1 if absent
+    };
+
+    std::shared_ptr<const Index> index;
+    const int* slotTable{nullptr};
+    int tableSize{};
+
+    std::vector<int> counts;
+    mutable int topSlot{-1};
+    int remaining{};
+};
+
+#endif // DISTANCE_MULTISET_H
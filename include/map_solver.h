@@ -5,6 +5,11 @@
 #include <chrono>
 #include <map>
 #include <optional>
+#include <utility>
+#include <cstdint>
+
+#include "distance_multiset.h"
+#include "search_budget.h"
 
 /**
  * MapSolver - a simplified PDE solver using backtracking
@@ -22,7 +27,13 @@ public:
 
     MapSolver(const std::vector<int>& inputDistances, int length);
     std::optional<std::vector<int>> solve();
+    SolveResult solve(const SearchBudget& budget);
+    // Same search, but the positions left for each site are computed at once
+    // as an AND of the distance bitset shifted by every placed site.
+    std::optional<std::vector<int>> solveBitset();
+    SolveResult solveBitset(const SearchBudget& budget);
     std::optional<std::vector<int>> solveWithCondition();
+    SolveResult solveWithCondition(const SearchBudget& budget);
 
     const std::vector<int>& getSolution() const { return stats.solution; }
     const Statistics& getStatistics() const { return stats; }
@@ -32,6 +43,7 @@ public:
 private:
     std::vector<int> distances;
     std::vector<int> currentMap;
+    std::vector<int> candidatePositions;   // ascending; the only positions tried for a site
     int totalLength{};
     int maxind{};
 
@@ -39,14 +51,41 @@ private:
     uint64_t processedPaths{};
     std::chrono::steady_clock::time_point startTime;
     Statistics stats;
+    BudgetGuard* guard{};
+
+    DistanceMultiset remainingDistances;
 
-    std::map<int, int> remainingDistances;
-    std::map<int, int> distanceCounter;
+    // Bitset mode only; empty otherwise. Bit d of presentBits (and bit L - d
+    // of mirroredBits) is set while distance d has copies left.
+    std::vector<uint64_t> presentBits;
+    std::vector<uint64_t> mirroredBits;
+    std::vector<uint64_t> candidateBits;
+    std::vector<std::vector<uint64_t>> depthMasks;
 
-    bool isValidPartialSolution(int assignedCount) const;
+    // Checks and consumes the distances from pos to sites [0, ind) only.
+    bool placeSite(int ind, int pos);
+    void unplaceSite(int ind);
+    void restoreDistance(int distVal);
+    std::pair<int, int> siteRange(int ind) const;
     void searchSolver(int ind, bool& foundSolution);
     void searchSolverWithCondition(int ind, bool& foundSolution);
+    void searchSolverBitset(int ind, bool& foundSolution);
+
+    void initializeBitsets();
+    static void setBit(std::vector<uint64_t>& bits, int i) { bits[static_cast<size_t>(i) / 64] |= 1ULL << (i % 64); }
+    static void clearBit(std::vector<uint64_t>& bits, int i) { bits[static_cast<size_t>(i) / 64] &= ~(1ULL << (i % 64)); }
+    // Word of bits shifted towards higher (Up) or lower (Down) indices.
+    static uint64_t shiftedUp(const std::vector<uint64_t>& bits, size_t word, int shift);
+    static uint64_t shiftedDown(const std::vector<uint64_t>& bits, size_t word, int shift);
+    // Word of a mask with bits [low, high] set.
+    static uint64_t rangeWord(size_t word, int low, int high);
+
+    bool outOfBudget() const { return guard && guard->exhausted(); }
+    // Working set of the search, reported to the budget once it is set up.
+    size_t memoryBytes() const;
+    void finishSearch();
 
+    void buildCandidatePositions();
     void initializeRemainingDistances();
     bool updateDistanceUsage(int distance, bool add);
     uint64_t calculateTotalPaths() const;
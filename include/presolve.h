@@ -0,0 +1,39 @@
+#ifndef PRESOLVE_H
+#define PRESOLVE_H
+
+#include <vector>
+#include <optional>
+
+#include "distance_multiset.h"
+
+/**
+ * Presolve - exact reduction of a distance multiset before any engine runs.
+ * Rejects inputs that no map can produce (size is not n(n-1)/2, a distance is
+ * not positive, the width or another distance occurs too often), divides all
+ * distances by their GCD, and replays the placements that have only one
+ * possible outcome: the first one by mirror symmetry, later ones when the
+ * other side does not fit. If these forced placements use every distance the
+ * map is returned directly; if one of them finds neither side fitting, the
+ * input is rejected. Otherwise the engines continue from the forced points
+ * and the distances they leave. Nothing that could belong to a map is ever
+ * discarded.
+ */
+namespace Presolve {
+    struct Result {
+        bool feasible{true};
+        const char* reason{""};           // why the input was rejected
+        std::vector<int> distances;        // the whole instance, divided by scale
+        int scale{1};                      // GCD the distances were divided by
+        size_t forcedPoints{};             // points placed without a choice
+        std::vector<int> placed;           // sorted: 0, the forced points and the width
+        DistanceMultiset remaining;        // distances placed does not account for
+        std::optional<std::vector<int>> solution;  // set if forced placements finished the map
+
+        // Maps a solution of distances back to the input's units.
+        std::vector<int> restore(const std::vector<int>& reducedMap) const;
+    };
+
+    Result reduce(const std::vector<int>& distances);
+}
+
+#endif // PRESOLVE_H
@@ -0,0 +1,105 @@
+#ifndef SEARCH_BUDGET_H
+#define SEARCH_BUDGET_H
+
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * CancellationToken - shared flag another thread can raise to stop a solver.
+ */
+class CancellationToken {
+public:
+    CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+    void cancel() { flag->store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return flag->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+// Zero means "no limit" for every field.
+struct SearchBudget {
+    std::chrono::milliseconds timeLimit{0};
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    uint64_t maxNodes{0};
+    size_t maxMemoryBytes{0};
+    std::optional<CancellationToken> cancellation;
+};
+
+enum class SolveStatus {
+    SOLVED,
+    NO_SOLUTION,
+    BUDGET_EXCEEDED,
+    CANCELLED
+};
+
+struct SearchStatistics {
+    uint64_t nodesExpanded{};
+    double elapsedMs{};
+    size_t peakMemoryBytes{};
+    // Lookups in a failed-state table, for solvers that use one.
+    uint64_t transpositionHits{};
+    uint64_t transpositionMisses{};
+};
+
+struct SolveResult {
+    SolveStatus status{SolveStatus::NO_SOLUTION};
+    std::optional<std::vector<int>> solution;
+    SearchStatistics stats;
+};
+
+const char* solveStatusName(SolveStatus status);
+
+/**
+ * BudgetGuard - enforces a SearchBudget from inside a solver's hot loop.
+ * expand() only bumps a counter; the clock and the cancellation token are
+ * polled on the first node and then every CHECK_INTERVAL nodes. Safe to share between worker threads.
+ */
+class BudgetGuard {
+public:
+    static constexpr uint64_t CHECK_INTERVAL = 1024;
+
+    explicit BudgetGuard(const SearchBudget& budget);
+
+    bool expand(uint64_t count = 1) {
+        uint64_t before = nodes.fetch_add(count, std::memory_order_relaxed);
+        if (maxNodes > 0 && before + count > maxNodes) {
+            fail(SolveStatus::BUDGET_EXCEEDED);
+            return false;
+        }
+        if (before % CHECK_INTERVAL == 0 || before / CHECK_INTERVAL != (before + count) / CHECK_INTERVAL) {
+            return poll();
+        }
+        return !exhausted();
+    }
+    // Reports the solver's current working-set size; false if over the cap.
+    bool trackMemory(size_t bytesInUse);
+    bool poll();
+
+    bool exhausted() const { return failure.load(std::memory_order_relaxed) != 0; }
+    // The memory cap in bytes, or 0 when unlimited.
+    size_t memoryLimit() const { return maxMemory; }
+    // Nodes the solver may still expand before hitting maxNodes.
+    uint64_t nodesLeft() const;
+    SolveResult finish(std::optional<std::vector<int>> solution) const;
+
+private:
+    std::chrono::steady_clock::time_point start;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    uint64_t maxNodes;
+    size_t maxMemory;
+    std::optional<CancellationToken> cancellation;
+
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<size_t> peakMemory{0};
+    std::atomic<int> failure{0};
+
+    void fail(SolveStatus status);
+};
+
+#endif // SEARCH_BUDGET_H
@@ -0,0 +1,48 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "zobrist.h"
+
+/**
+ * Symmetry - canonical-orientation rule shared by the branch and bound engines.
+ * A map and its mirror image (width - x) produce the same distances. When the
+ * placed points are their own mirror image, the width - y branch is the y
+ * branch reflected, so only the y branch is searched; every map is still
+ * found in one of its two orientations.
+ */
+namespace Symmetry {
+    // Sorted points, first 0 and last the width.
+    inline bool isSelfMirror(const int* sorted, size_t count) {
+        int width = sorted[count - 1];
+        for (size_t i = 0; i < (count + 1) / 2; ++i) {
+            if (sorted[i] + sorted[count - 1 - i] != width) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool isMirrorOf(const int* a, const int* b, size_t count) {
+        int width = a[count - 1];
+        for (size_t i = 0; i < count; ++i) {
+            if (b[i] != width - a[count - 1 - i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Zobrist fingerprint of the mirror image of points.
+    inline uint64_t mirrorFingerprint(const int* points, size_t count, int width) {
+        uint64_t hash = 0;
+        for (size_t i = 0; i < count; ++i) {
+            hash ^= Zobrist::key(width - points[i]);
+        }
+        return hash;
+    }
+}
+
+#endif // SYMMETRY_H
@@ -6,6 +6,7 @@
 #include <chrono>
 #include <optional>
 #include <filesystem>
+#include <functional>
 
 #include "instance_generator.h"
 #include "map_solver.h"
@@ -16,6 +17,8 @@
 #include "algorithms/bbd_algorithm.h"
 #include "data_arrangement_benchmark.h"
 #include "data_arrangement_analysis.h"
+#include "delta_kernel_benchmark.h"
+#include "presolve.h"
 
 class TestFramework {
 private:
@@ -34,6 +37,12 @@ private:
         double verificationTimeMs;
     };
 
+    static SearchBudget executionBudget();
+    // Runs solve on the presolved instance and maps its map back to the input's units.
+    static SolveResult solvePresolved(const std::vector<int>& distances,
+                                      const std::function<SolveResult(const Presolve::Result&)>& solve);
+    // Finishes the forced placements of a presolved instance with BBb.
+    SolveResult solveWithBBb(const Presolve::Result& reduced);
     bool generateInstance(int cuts, const std::string& filename, SortOrder order);
     SortOrder getSortOrderFromUser();
     bool isValidNumberOfCuts(int cuts) const;
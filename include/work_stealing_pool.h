@@ -0,0 +1,54 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+
+/**
+ * WorkStealingPool - fixed set of workers, each with its own task deque.
+ * A worker pushes and pops its own tasks LIFO and steals FIFO from the
+ * others when it runs dry, so large subtrees near the root get stolen first.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threadCount);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    int threadCount() const { return static_cast<int>(workers.size()); }
+    // Index of the calling worker in [0, threadCount), or -1 outside the pool.
+    int currentWorker() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allDone;
+    std::atomic<size_t> pendingTasks{0};
+    std::atomic<size_t> queuedTasks{0};
+    std::atomic<size_t> nextQueue{0};
+    bool stopping{false};
+
+    void workerLoop(int index);
+    bool popTask(int index, std::function<void()>& task);
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,39 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Zobrist - order-independent 64-bit fingerprints of point sets.
+ * A set hashes to the XOR of its points' keys, so placing or removing a
+ * point updates the fingerprint in O(1). Keys come from a splitmix64 mix
+ * of the coordinate, which needs no table and covers any width.
+ */
+namespace Zobrist {
+    inline uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    inline uint64_t key(int value) {
+        return mix(static_cast<uint64_t>(static_cast<uint32_t>(value)) + 0x9E3779B97F4A7C15ULL);
+    }
+
+    // Independent keys for distances. Multisets hash to the wrapping sum of
+    // their elements' keys, so repeated values do not cancel as with XOR.
+    inline uint64_t distanceKey(int value) {
+        return mix(static_cast<uint64_t>(static_cast<uint32_t>(value)) + 0xD1B54A32D192ED03ULL);
+    }
+
+    inline uint64_t ofPoints(const int* points, size_t count) {
+        uint64_t hash = 0;
+        for (size_t i = 0; i < count; ++i) {
+            hash ^= key(points[i]);
+        }
+        return hash;
+    }
+}
+
+#endif // ZOBRIST_H
@@ -1,130 +1,553 @@
 #include "../../include/algorithms/bbb2_algorithm.h"
+#include "../../include/work_stealing_pool.h"
+#include "../../include/zobrist.h"
+#include "../../include/symmetry.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 
-static std::string encodeState(const std::vector<int>& X, const MultisetD& mD) {
-    std::stringstream ss;
-    ss << "X:";
-    for (int x : X) {
-        ss << x << "|";
-    }
-    ss << "D:";
-    auto vec = mD.toVector();
-    std::sort(vec.begin(), vec.end());
-    for (int v : vec) {
-        ss << v << "|";
+BBb2Algorithm::BBb2Algorithm() = default;
+BBb2Algorithm::~BBb2Algorithm() = default;
+
+void BBb2Algorithm::setThreadCount(int threads) {
+    int count = std::max(1, threads);
+    if (count != threadCount) {
+        pool.reset();
     }
-    return ss.str();
+    threadCount = count;
+    bbbSolver.setThreadCount(count);
 }
 
 std::optional<std::vector<int>> BBb2Algorithm::solve(std::vector<int> D) {
+    return solve(std::move(D), SearchBudget{}).solution;
+}
+
+SolveResult BBb2Algorithm::solve(std::vector<int> D, const SearchBudget& budget) {
+    BudgetGuard guard(budget);
     originalDistances = D;
-    std::sort(D.begin(), D.end(), std::greater<int>());
     if (D.empty()) {
-        return std::nullopt;
+        return guard.finish(std::nullopt);
     }
-    int width = D.front();
+    auto it = std::max_element(D.begin(), D.end());
+    int width = *it;
+    D.erase(it);
+    return solveFrom({0, width}, DistanceMultiset(D), guard);
+}
 
-    auto it = std::find(D.begin(), D.end(), width);
-    if (it != D.end()) {
-        D.erase(it);
+SolveResult BBb2Algorithm::solvePartial(const std::vector<int>& placed,
+                                        const DistanceMultiset& remaining,
+                                        const SearchBudget& budget)
+{
+    BudgetGuard guard(budget);
+    // Maps are validated against the whole instance.
+    originalDistances = remaining.toVector();
+    for (size_t i = 0; i < placed.size(); ++i) {
+        for (size_t j = i + 1; j < placed.size(); ++j) {
+            originalDistances.push_back(placed[j] - placed[i]);
+        }
     }
-    std::vector<int> X0 = {0, width};
+    return solveFrom(placed, remaining, guard);
+}
 
-    int n = calculateN(static_cast<int>(D.size()));
-    int alphaM = findAlphaM(static_cast<int>(D.size()));
+SolveResult BBb2Algorithm::solveFrom(const std::vector<int>& X0, const DistanceMultiset& D, BudgetGuard& guard) {
+    std::vector<AlphaNode> alphaNodes = prepareAlphaNodes(X0, D, guard);
+    if (threadCount > 1 && alphaNodes.size() > 1) {
+        return guard.finish(solveAlphaNodesParallel(alphaNodes, guard));
+    }
+    return guard.finish(solveAlphaNodes(alphaNodes, guard));
+}
 
-    std::vector<AlphaNode> alphaNodes;
-    buildToAlpha(alphaNodes, D, X0, alphaM);
+EnumerationResult BBb2Algorithm::enumerate(std::vector<int> D,
+                                           SolutionCallback onSolution,
+                                           const EnumerationOptions& options)
+{
+    SolutionSink sink(std::move(onSolution), options);
+    originalDistances = D;
+    if (D.empty()) {
+        return sink.finish(true);
+    }
+    SearchBudget budget;
+    budget.timeLimit = options.timeLimit;
+    BudgetGuard guard(budget);
+    auto it = std::max_element(D.begin(), D.end());
+    int width = *it;
+    D.erase(it);
+    std::vector<AlphaNode> alphaNodes = prepareAlphaNodes({0, width}, DistanceMultiset(D), guard);
+    if (guard.exhausted()) {
+        return sink.finish(false);
+    }
 
-    std::sort(alphaNodes.begin(), alphaNodes.end(),
-              [](const AlphaNode &a, const AlphaNode &b) {
-                  auto va = a.D.toVector();
-                  auto vb = b.D.toVector();
-                  return va.size() < vb.size();
-              });
+    auto report = [this, &sink](const std::vector<int>& X) {
+        if (!isValidSolution(X, originalDistances)) {
+            return !sink.shouldStop();
+        }
+        return sink.offer(X);
+    };
+    auto shouldStop = [&sink]() { return sink.shouldStop(); };
 
     for (const auto& node : alphaNodes) {
+        if (sink.shouldStop()) {
+            return sink.finish(false);
+        }
         if (node.D.empty()) {
-            if (isValidSolution(node.X, originalDistances)) {
-                return node.X;
+            if (!report(node.X)) {
+                return sink.finish(false);
             }
             continue;
         }
-        auto solution = processAlphaNode(node);
-        if (solution && isValidSolution(*solution, originalDistances)) {
-            return solution;
+        if (!bbbSolver.enumeratePartial(node.X, node.D, report, shouldStop)) {
+            return sink.finish(false);
         }
     }
-    return std::nullopt;
+    return sink.finish(true);
+}
+
+std::vector<BBb2Algorithm::AlphaNode> BBb2Algorithm::prepareAlphaNodes(const std::vector<int>& X0,
+                                                                      const DistanceMultiset& D,
+                                                                      BudgetGuard& guard)
+{
+    std::vector<AlphaNode> alphaNodes;
+    if (!buildToAlpha(alphaNodes, D, X0, guard)) {
+        return {};
+    }
+
+    // Nodes whose next distance fits on neither side have no completion.
+    for (auto& node : alphaNodes) {
+        node.metrics = measure(node);
+    }
+    alphaNodes.erase(std::remove_if(alphaNodes.begin(), alphaNodes.end(),
+                                    [](const AlphaNode& node) {
+                                        return node.metrics.remaining > 0 && node.metrics.openBranches == 0;
+                                    }),
+                     alphaNodes.end());
+    std::stable_sort(alphaNodes.begin(), alphaNodes.end(),
+                     [this](const AlphaNode& a, const AlphaNode& b) {
+                         return alphaPriority(a.metrics, b.metrics);
+                     });
+    return alphaNodes;
 }
 
-void BBb2Algorithm::buildToAlpha(
+bool BBb2Algorithm::easiestFirst(const AlphaMetrics& a, const AlphaMetrics& b) {
+    if (a.remaining != b.remaining) {
+        return a.remaining < b.remaining;
+    }
+    return a.openBranches < b.openBranches;
+}
+
+BBb2Algorithm::AlphaMetrics BBb2Algorithm::measure(AlphaNode& node) {
+    AlphaMetrics metrics;
+    metrics.remaining = node.D.size();
+    if (node.D.empty()) {
+        return metrics;
+    }
+    metrics.maxDistance = node.D.max();
+    int width = node.X.back();
+    int branches[2] = {metrics.maxDistance, width - metrics.maxDistance};
+    int branchCount = (branches[1] != branches[0]) ? 2 : 1;
+    for (int b = 0; b < branchCount; ++b) {
+        if (node.D.removeDeltas(branches[b], node.X)) {
+            ++metrics.openBranches;
+            node.D.restoreDeltas(branches[b], node.X);
+        }
+    }
+    return metrics;
+}
+
+bool BBb2Algorithm::buildToAlpha(
     std::vector<AlphaNode>& alphaNodes,
-    const std::vector<int>& initialD,
+    const DistanceMultiset& initialD,
     const std::vector<int>& initialX,
-    int alpha
+    BudgetGuard& guard
 ) {
-    MultisetD msD = MultisetD::fromVector(initialD);
-    std::queue<AlphaNode> Q;
-    Q.push(AlphaNode(msD, initialX));
-
-    std::unordered_set<std::string> visited;
-    visited.insert(encodeState(initialX, msD));
-
-    int level = 0;
-    while (!Q.empty() && level < alpha) {
-        int levelSize = static_cast<int>(Q.size());
-        for (int i = 0; i < levelSize; i++) {
-            auto current = Q.front();
-            Q.pop();
-
-            auto dVec = current.D.toVector();
-            if (dVec.empty()) {
-                alphaNodes.push_back(current);
-                continue;
+    std::vector<AlphaNode> level;
+    level.push_back(AlphaNode(initialD, initialX, rootKey(initialD, initialX)));
+
+    visited.reset(verifyStates);
+    visited.insert(level.front());
+
+    // The root is expanded as if each node had two distinct children.
+    double branching = 2.0;
+    double dedupRate = 0.0;
+    size_t frontierBytes = 0;
+    for (alphaDepth = 0; shouldDeepen(level, branching, dedupRate, frontierBytes, guard); ++alphaDepth) {
+        std::vector<AlphaNode> candidates;
+        if (threadCount > 1 && level.size() >= BBbAlgorithm::PARALLEL_LEVEL_MIN) {
+            if (!expandLevelParallel(level, candidates, guard)) {
+                return false;
             }
-            int m = *std::max_element(dVec.begin(), dVec.end());
-            int width = current.X.back();
-
-            if (m >= 0 && m <= width) {
-                MultisetD newD = current.D;
-                if (removeDelta(newD, m, current.X)) {
-                    std::vector<int> newX = current.X;
-                    newX.push_back(m);
-                    std::sort(newX.begin(), newX.end());
-                    std::string st = encodeState(newX, newD);
-                    if (visited.find(st) == visited.end()) {
-                        visited.insert(st);
-                        Q.push(AlphaNode(std::move(newD), std::move(newX)));
-                    }
+        } else {
+            for (const auto& node : level) {
+                if (node.D.empty()) {
+                    continue;
+                }
+                if (!guard.expand()) {
+                    return false;
                 }
+                expandAlphaNode(node, candidates);
             }
+        }
 
-            int cmpl = width - m;
-            if (cmpl != m && cmpl >= 0 && cmpl <= width) {
-                MultisetD newD2 = current.D;
-                if (removeDelta(newD2, cmpl, current.X)) {
-                    std::vector<int> newX2 = current.X;
-                    newX2.push_back(cmpl);
-                    std::sort(newX2.begin(), newX2.end());
-                    std::string st2 = encodeState(newX2, newD2);
-                    if (visited.find(st2) == visited.end()) {
-                        visited.insert(st2);
-                        Q.push(AlphaNode(std::move(newD2), std::move(newX2)));
-                    }
+        // The level and its candidates are alive together until the merge.
+        size_t levelBytes = 0;
+        for (const auto& node : level) {
+            levelBytes += nodeBytes(node);
+        }
+        for (const auto& candidate : candidates) {
+            levelBytes += nodeBytes(candidate);
+        }
+
+        std::vector<AlphaNode> nextLevel;
+        nextLevel.reserve(candidates.size());
+        size_t expanded = 0;
+        for (auto& node : level) {
+            if (node.D.empty()) {
+                alphaNodes.push_back(std::move(node));
+            } else {
+                ++expanded;
+            }
+        }
+        for (auto& candidate : candidates) {
+            if (!visited.containsMirror(candidate) && visited.insert(candidate)) {
+                nextLevel.push_back(std::move(candidate));
+            }
+        }
+        if (expanded > 0) {
+            branching = static_cast<double>(nextLevel.size()) / static_cast<double>(expanded);
+        }
+        if (!candidates.empty()) {
+            dedupRate = 1.0 - static_cast<double>(nextLevel.size()) / static_cast<double>(candidates.size());
+        }
+        level = std::move(nextLevel);
+        frontierBytes = levelBytes + visited.memoryBytes();
+        if (!guard.trackMemory(frontierBytes)) {
+            return false;
+        }
+    }
+    for (auto& node : level) {
+        alphaNodes.push_back(std::move(node));
+    }
+    return true;
+}
+
+bool BBb2Algorithm::shouldDeepen(const std::vector<AlphaNode>& level,
+                                 double branching,
+                                 double dedupRate,
+                                 size_t frontierBytes,
+                                 const BudgetGuard& guard) const
+{
+    // Nodes on one level all hold the same number of points and distances.
+    auto open = std::find_if(level.begin(), level.end(),
+                             [](const AlphaNode& node) { return !node.D.empty(); });
+    if (open == level.end()) {
+        return false;
+    }
+    size_t width = level.size();
+    size_t levelBytes = width * nodeBytes(*open);
+    size_t childBytes = nodeBytes(*open) + sizeof(int);
+    // The budget's cap aborts the solve, so the next level must fit even at
+    // its worst: every node keeps both children and none is a duplicate.
+    size_t cap = guard.memoryLimit();
+    if (cap > 0) {
+        size_t bound = levelBytes + 2 * width * childBytes + visited.memoryBytesAfter(2 * width);
+        if (frontierBytes > cap || bound > cap) {
+            return false;
+        }
+    }
+    // The frontier target only ends this phase, so the level as measured and
+    // a projection of the next one are enough: the last level's surviving
+    // children per node, scaled back up by the share dedup removed.
+    if (alphaCutoff.maxFrontierBytes > 0) {
+        double candidates = std::min(2.0 * static_cast<double>(width),
+                                     static_cast<double>(width) * branching / std::max(1.0 - dedupRate, 0.5));
+        double projected = static_cast<double>(levelBytes) + candidates * static_cast<double>(childBytes)
+                         + static_cast<double>(visited.memoryBytes());
+        if (frontierBytes > alphaCutoff.maxFrontierBytes ||
+            projected > static_cast<double>(alphaCutoff.maxFrontierBytes)) {
+            return false;
+        }
+    }
+    if (level.size() < alphaCutoff.nodesPerThread * static_cast<size_t>(threadCount)) {
+        return true;
+    }
+    // Many transpositions: the breadth-first phase is still merging work
+    // that per-node searches would each repeat.
+    return dedupRate >= alphaCutoff.dedupContinue;
+}
+
+size_t BBb2Algorithm::nodeBytes(const AlphaNode& node) {
+    return sizeof(AlphaNode) + node.D.memoryBytes() + (node.X.size() + 1) * sizeof(int);
+}
+
+BBb2Algorithm::StateKey BBb2Algorithm::rootKey(const DistanceMultiset& D, const std::vector<int>& X) {
+    StateKey key;
+    key.points = Zobrist::ofPoints(X.data(), X.size());
+    for (int slot = 0; slot < D.distinctCount(); ++slot) {
+        key.distances += static_cast<uint64_t>(D.countAt(slot)) * Zobrist::distanceKey(D.valueAt(slot));
+    }
+    return key;
+}
+
+void BBb2Algorithm::expandAlphaNode(const AlphaNode& current, std::vector<AlphaNode>& out) {
+    int m = current.D.max();
+    int width = current.X.back();
+
+    if (m >= 0 && m <= width) {
+        addCandidate(current, m, out);
+    }
+    int cmpl = width - m;
+    if (cmpl != m && cmpl >= 0 && cmpl <= width &&
+        !Symmetry::isSelfMirror(current.X.data(), current.X.size())) {
+        addCandidate(current, cmpl, out);
+    }
+}
+
+void BBb2Algorithm::addCandidate(const AlphaNode& current, int y, std::vector<AlphaNode>& out) {
+    StateKey key = current.key;
+    key.points ^= Zobrist::key(y);
+    for (int x : current.X) {
+        key.distances -= Zobrist::distanceKey(std::abs(y - x));
+    }
+    // States from earlier levels are rejected before anything is copied;
+    // repeats within this level are caught when the level is merged.
+    if (!verifyStates && visited.contains(key)) {
+        return;
+    }
+    DistanceMultiset newD = current.D;
+    if (!newD.removeDeltas(y, current.X)) {
+        return;
+    }
+    std::vector<int> newX;
+    newX.reserve(current.X.size() + 1);
+    auto split = std::lower_bound(current.X.begin(), current.X.end(), y);
+    newX.insert(newX.end(), current.X.begin(), split);
+    newX.push_back(y);
+    newX.insert(newX.end(), split, current.X.end());
+    out.push_back(AlphaNode(std::move(newD), std::move(newX), key));
+}
+
+bool BBb2Algorithm::expandLevelParallel(const std::vector<AlphaNode>& level,
+                                        std::vector<AlphaNode>& candidates,
+                                        BudgetGuard& guard)
+{
+    if (!pool) {
+        pool = std::make_unique<WorkStealingPool>(threadCount);
+    }
+    // Contiguous slices concatenated in order give the serial candidate order.
+    size_t chunkCount = std::max<size_t>(1, std::min(level.size() / 64, static_cast<size_t>(threadCount) * 4));
+    size_t chunkSize = (level.size() + chunkCount - 1) / chunkCount;
+    std::vector<std::vector<AlphaNode>> chunkOut(chunkCount);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        pool->submit([this, &level, &chunkOut, &guard, c, chunkSize] {
+            size_t end = std::min(level.size(), (c + 1) * chunkSize);
+            for (size_t i = c * chunkSize; i < end; ++i) {
+                if (level[i].D.empty()) {
+                    continue;
                 }
+                if (!guard.expand()) {
+                    return;
+                }
+                expandAlphaNode(level[i], chunkOut[c]);
             }
+        });
+    }
+    pool->wait();
+    if (guard.exhausted()) {
+        return false;
+    }
+    for (auto& part : chunkOut) {
+        std::move(part.begin(), part.end(), std::back_inserter(candidates));
+    }
+    return true;
+}
+
+void BBb2Algorithm::VisitedStates::reset(bool verifyMode) {
+    verify = verifyMode;
+    std::fill(table.begin(), table.end(), -1);
+    keys.clear();
+    states.clear();
+    collisionCount = 0;
+}
+
+bool BBb2Algorithm::VisitedStates::contains(const StateKey& key) const {
+    if (table.empty()) {
+        return false;
+    }
+    for (size_t bucket = bucketOf(key) & mask; table[bucket] >= 0; bucket = (bucket + 1) & mask) {
+        if (keys[static_cast<size_t>(table[bucket])] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BBb2Algorithm::VisitedStates::containsMirror(const AlphaNode& node) const {
+    const std::vector<int>& X = node.X;
+    if (table.empty() || Symmetry::isSelfMirror(X.data(), X.size())) {
+        return false;
+    }
+    // The mirror state has the same distances and the mirrored points.
+    StateKey key{Symmetry::mirrorFingerprint(X.data(), X.size(), X.back()), node.key.distances};
+    for (size_t bucket = bucketOf(key) & mask; table[bucket] >= 0; bucket = (bucket + 1) & mask) {
+        size_t entry = static_cast<size_t>(table[bucket]);
+        if (!(keys[entry] == key)) {
+            continue;
+        }
+        if (!verify) {
+            return true;
+        }
+        const AlphaNode& other = states[entry];
+        if (other.X.size() == X.size() && Symmetry::isMirrorOf(X.data(), other.X.data(), X.size()) &&
+            other.D == node.D) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BBb2Algorithm::VisitedStates::insert(const AlphaNode& node) {
+    if ((keys.size() + 1) * 2 > table.size()) {
+        grow();
+    }
+    size_t bucket = bucketOf(node.key) & mask;
+    for (; table[bucket] >= 0; bucket = (bucket + 1) & mask) {
+        size_t entry = static_cast<size_t>(table[bucket]);
+        if (!(keys[entry] == node.key)) {
+            continue;
+        }
+        if (!verify) {
+            return false;
+        }
+        if (states[entry].X == node.X && states[entry].D == node.D) {
+            return false;
+        }
+        ++collisionCount;
+    }
+    table[bucket] = static_cast<int>(keys.size());
+    keys.push_back(node.key);
+    if (verify) {
+        states.push_back(node);
+    }
+    return true;
+}
+
+size_t BBb2Algorithm::VisitedStates::memoryBytesAfter(size_t added) const {
+    size_t count = keys.size() + added;
+    size_t tableSize = table.size();
+    while ((count + 1) * 2 > tableSize) {
+        tableSize = std::max<size_t>(64, tableSize * 2);
+    }
+    // A vector at most doubles its capacity when it grows.
+    auto grown = [count](size_t capacity) {
+        return count > capacity ? std::max(2 * capacity, count) : capacity;
+    };
+    size_t keyCapacity = grown(keys.capacity());
+    size_t stateCapacity = verify ? grown(states.capacity()) : states.capacity();
+    return tableSize * sizeof(int) + keyCapacity * sizeof(StateKey) + stateCapacity * sizeof(AlphaNode);
+}
+
+void BBb2Algorithm::VisitedStates::grow() {
+    size_t capacity = std::max<size_t>(64, table.size() * 2);
+    table.assign(capacity, -1);
+    mask = capacity - 1;
+    for (size_t entry = 0; entry < keys.size(); ++entry) {
+        size_t bucket = bucketOf(keys[entry]) & mask;
+        while (table[bucket] >= 0) {
+            bucket = (bucket + 1) & mask;
+        }
+        table[bucket] = static_cast<int>(entry);
+    }
+}
+
+std::optional<std::vector<int>> BBb2Algorithm::solveAlphaNodes(const std::vector<AlphaNode>& alphaNodes,
+                                                               BudgetGuard& guard)
+{
+    for (const auto& node : alphaNodes) {
+        if (guard.exhausted()) {
+            break;
+        }
+        auto solution = processAlphaNode(node, bbbSolver, guard);
+        if (solution && isValidSolution(*solution, originalDistances)) {
+            return solution;
         }
-        level++;
     }
-    while (!Q.empty()) {
-        alphaNodes.push_back(Q.front());
-        Q.pop();
+    return std::nullopt;
+}
+
+std::optional<std::vector<int>> BBb2Algorithm::solveAlphaNodesParallel(const std::vector<AlphaNode>& alphaNodes,
+                                                                       BudgetGuard& guard)
+{
+    if (!pool) {
+        pool = std::make_unique<WorkStealingPool>(threadCount);
+    }
+    // The inner solvers run inside pool tasks and must not wait on the pool themselves.
+    while (alphaSolvers.size() < static_cast<size_t>(threadCount)) {
+        alphaSolvers.push_back(std::make_unique<BBbAlgorithm>());
+    }
+
+    AlphaContext ctx(static_cast<size_t>(threadCount));
+    ctx.nodes = &alphaNodes;
+    ctx.guard = &guard;
+    // One long-lived task per worker pulling nodes in index order, so low
+    // indices are settled first and a lowest-index win stops the rest early.
+    for (size_t w = 0; w < ctx.slots.size(); ++w) {
+        pool->submit([this, &ctx, w] { runAlphaWorker(ctx, w); });
+    }
+    pool->wait();
+    return ctx.solution;
+}
+
+void BBb2Algorithm::runAlphaWorker(AlphaContext& ctx, size_t worker) {
+    AlphaSlot& slot = ctx.slots[worker];
+    BBbAlgorithm& solver = *alphaSolvers[worker];
+    while (!ctx.guard->exhausted()) {
+        size_t index = ctx.nextNode.fetch_add(1);
+        if (index >= ctx.nodes->size() || !alphaNodeCanWin(ctx, index)) {
+            return;
+        }
+        slot.node.store(index);
+        slot.stop.store(false);
+        // A winner recorded before the slot was published did not see it.
+        if (!alphaNodeCanWin(ctx, index)) {
+            return;
+        }
+        auto solution = processAlphaNode((*ctx.nodes)[index], solver, *ctx.guard, &slot.stop);
+        if (solution && isValidSolution(*solution, originalDistances)) {
+            recordAlphaSolution(ctx, index, std::move(*solution));
+        }
+    }
+}
+
+bool BBb2Algorithm::alphaNodeCanWin(const AlphaContext& ctx, size_t index) const {
+    size_t best = ctx.bestNode.load();
+    if (best == std::numeric_limits<size_t>::max()) {
+        return true;
     }
+    return solutionPolicy == SolutionPolicy::LOWEST_INDEX && index < best;
 }
 
-std::optional<std::vector<int>> BBb2Algorithm::processAlphaNode(const AlphaNode& node) {
-    auto remainVec = node.D.toVector();
-    auto partialSol = bbbSolver.solvePartial(node.X, remainVec);
+void BBb2Algorithm::recordAlphaSolution(AlphaContext& ctx, size_t index, std::vector<int> X) {
+    std::lock_guard<std::mutex> lock(ctx.solutionMutex);
+    if (!alphaNodeCanWin(ctx, index)) {
+        return;
+    }
+    ctx.bestNode.store(index);
+    ctx.solution = std::move(X);
+    for (auto& slot : ctx.slots) {
+        if (!alphaNodeCanWin(ctx, slot.node.load())) {
+            slot.stop.store(true);
+        }
+    }
+}
+
+std::optional<std::vector<int>> BBb2Algorithm::processAlphaNode(const AlphaNode& node,
+                                                                BBbAlgorithm& solver,
+                                                                BudgetGuard& guard,
+                                                                const std::atomic<bool>* stop)
+{
+    if (node.D.empty()) {
+        return node.X;
+    }
+    auto partialSol = solver.solvePartial(node.X, node.D, guard, stop);
     if (!partialSol) {
         return std::nullopt;
     }
@@ -148,41 +571,3 @@ bool BBb2Algorithm::isValidSolution(const std::vector<int>& X, const std::vector
     std::sort(sortedOrig.begin(), sortedOrig.end());
     return (genD == sortedOrig);
 }
-
-bool BBb2Algorithm::removeDelta(MultisetD &mD, int y, const std::vector<int>& X) {
-    for (int x : X) {
-        int d = std::abs(y - x);
-        if (!mD.contains(d)) {
-            return false;
-        }
-    }
-    for (int x : X) {
-        int d = std::abs(y - x);
-        mD.remove(d);
-    }
-    return true;
-}
-
-int BBb2Algorithm::calculateN(int setSize) const {
-    double disc = 1.0 + 8.0 * static_cast<double>(setSize);
-    double val = (std::sqrt(disc) + 1.0) / 2.0;
-    return static_cast<int>(std::round(val));
-}
-
-int BBb2Algorithm::findAlphaM(int N) const {
-    int nCalc = calculateN(N);
-    if (nCalc <= 3) {
-        return 1;
-    }
-    double bestScore = 1e18;
-    int bestAlpha = 1;
-    for (int alpha = 1; alpha < nCalc; alpha++) {
-        double c = (nCalc * nCalc * std::pow(2.0, alpha))
-                 + (nCalc * nCalc * std::pow(2.0, static_cast<double>(nCalc - alpha)));
-        if (c < bestScore) {
-            bestScore = c;
-            bestAlpha = alpha;
-        }
-    }
-    return bestAlpha;
-}
@@ -1,176 +1,451 @@
 #include "../../include/algorithms/bbb_algorithm.h"
+#include "../../include/zobrist.h"
+#include "../../include/symmetry.h"
+#include "../../include/algorithms/lookahead.h"
+#include "../../include/work_stealing_pool.h"
 #include <queue>
 #include <functional>
 #include <iostream>
+#include <iterator>
+
+BBbAlgorithm::BBbAlgorithm() = default;
+BBbAlgorithm::~BBbAlgorithm() = default;
+
+void BBbAlgorithm::setThreadCount(int threads) {
+    int count = std::max(1, threads);
+    if (count != threadCount) {
+        pool.reset();
+    }
+    threadCount = count;
+}
 
 std::optional<std::vector<int>> BBbAlgorithm::solve(std::vector<int> D) {
-    if (D.empty()) return std::nullopt;
+    return solve(std::move(D), SearchBudget{}).solution;
+}
+
+SolveResult BBbAlgorithm::solve(std::vector<int> D, const SearchBudget& budget) {
+    BudgetGuard guard(budget);
+    if (D.empty()) return guard.finish(std::nullopt);
     int width = *std::max_element(D.begin(), D.end());
     auto it = std::find(D.begin(), D.end(), width);
     if (it != D.end()) {
         D.erase(it);
     }
     std::vector<int> X0 = {0, width};
+    return guard.finish(solvePartial(X0, std::move(D), guard));
+}
+
+std::optional<std::vector<int>> BBbAlgorithm::solvePartial(const std::vector<int>& partialX,
+                                                           std::vector<int> leftoverD)
+{
+    BudgetGuard guard(SearchBudget{});
+    return solvePartial(partialX, std::move(leftoverD), guard);
+}
+
+std::optional<std::vector<int>> BBbAlgorithm::solvePartial(const std::vector<int>& partialX,
+                                                           std::vector<int> leftoverD,
+                                                           BudgetGuard& guard)
+{
+    return solvePartial(partialX, DistanceMultiset(leftoverD), guard);
+}
 
-    std::vector<std::vector<int>> LD = {D};
-    std::vector<std::vector<int>> LX = {X0};
+std::optional<std::vector<int>> BBbAlgorithm::solvePartial(const std::vector<int>& partialX,
+                                                           const DistanceMultiset& leftoverD,
+                                                           BudgetGuard& guard,
+                                                           const std::atomic<bool>* stop)
+{
+    if (leftoverD.empty()) {
+        return partialX;
+    }
+    stopFlag = stop;
+    stopCheck = nullptr;
+    int width = partialX.back();
+    seedFrontier(leftoverD, partialX);
+    size_t ceiling = memoryCeiling(guard);
 
-    while (!LD.empty()) {
-        generateNextLevel(LD, LX);
-        for (size_t i = 0; i < LD.size(); ++i) {
-            if (LD[i].empty()) {
-                return LX[i];
+    while (!current.empty()) {
+        if (!nextLevelFits(ceiling)) {
+            std::optional<std::vector<int>> found;
+            searchDepthFirst(guard, [&found](const std::vector<int>& X) {
+                found = X;
+                return false;
+            });
+            return found;
+        }
+        if (!generateNextLevel(width, guard)) {
+            return std::nullopt;
+        }
+        for (size_t i = 0; i < current.size(); ++i) {
+            if (current.remaining(i) == 0) {
+                return current.pointsOf(i);
             }
         }
     }
     return std::nullopt;
 }
 
-std::optional<std::vector<int>> BBbAlgorithm::solvePartial(const std::vector<int>& partialX,
-                                                           std::vector<int> leftoverD)
+bool BBbAlgorithm::enumeratePartial(const std::vector<int>& partialX,
+                                    std::vector<int> leftoverD,
+                                    const SolutionCallback& onSolution,
+                                    const std::function<bool()>& shouldStop)
+{
+    return enumeratePartial(partialX, DistanceMultiset(leftoverD), onSolution, shouldStop);
+}
+
+bool BBbAlgorithm::enumeratePartial(const std::vector<int>& partialX,
+                                    const DistanceMultiset& leftoverD,
+                                    const SolutionCallback& onSolution,
+                                    const std::function<bool()>& shouldStop)
 {
     if (leftoverD.empty()) {
-        return partialX;
+        return onSolution(partialX);
     }
+    stopFlag = nullptr;
+    stopCheck = shouldStop ? &shouldStop : nullptr;
     int width = partialX.back();
-    std::vector<std::vector<int>> LD = { leftoverD };
-    std::vector<std::vector<int>> LX = { partialX };
-
-    while (!LD.empty()) {
-        generateNextLevelPartial(LD, LX, width);
-        for (size_t i = 0; i < LD.size(); ++i) {
-            if (LD[i].empty()) {
-                return LX[i];
+    seedFrontier(leftoverD, partialX);
+    BudgetGuard guard(SearchBudget{});
+    size_t ceiling = memoryCeiling(guard);
+
+    while (!current.empty()) {
+        if (shouldStop && shouldStop()) {
+            return false;
+        }
+        if (!nextLevelFits(ceiling)) {
+            return searchDepthFirst(guard, [&](const std::vector<int>& X) {
+                return onSolution(X) && !(shouldStop && shouldStop());
+            });
+        }
+        if (!generateNextLevel(width, guard)) {
+            return false;
+        }
+        for (size_t i = 0; i < current.size(); ++i) {
+            if (current.remaining(i) == 0 && !onSolution(current.pointsOf(i))) {
+                return false;
             }
         }
     }
-    return std::nullopt;
+    return true;
 }
 
-std::vector<int> BBbAlgorithm::calculateDelta(int y, const std::vector<int>& X) {
-    std::vector<int> delta;
-    delta.reserve(X.size());
-    for (int x : X) {
-        delta.push_back(std::abs(y - x));
+void BBbAlgorithm::seedFrontier(DistanceMultiset root, const std::vector<int>& X) {
+    current.reset();
+    current.push(X, root.size());
+    scratch.D = std::move(root);
+    scratch.X = X;
+}
+
+void BBbAlgorithm::materialize(size_t row, Scratch& work) const {
+    // Rows only ever gain points over the root, so the state of any row is
+    // reached from any other by dropping the points it lacks (restoring their
+    // distances) and then placing the ones it adds. Neighbouring rows share
+    // most of their points, which keeps the diff to a few placements.
+    const int* target = current.points(row);
+    size_t count = current.pointCount(row);
+    work.dropped.clear();
+    work.added.clear();
+    std::set_difference(work.X.begin(), work.X.end(), target, target + count,
+                        std::back_inserter(work.dropped));
+    std::set_difference(target, target + count, work.X.begin(), work.X.end(),
+                        std::back_inserter(work.added));
+
+    for (int p : work.dropped) {
+        work.X.erase(std::lower_bound(work.X.begin(), work.X.end(), p));
+        work.D.restoreDeltas(p, work.X);
+    }
+    for (int q : work.added) {
+        work.D.removeDeltas(q, work.X);
+        work.X.insert(std::lower_bound(work.X.begin(), work.X.end(), q), q);
     }
-    return delta;
+    work.hash = current.fingerprint(row);
+}
+
+size_t BBbAlgorithm::memoryCeiling(const BudgetGuard& guard) const {
+    size_t ceiling = guard.memoryLimit();
+    if (memoryLimit > 0 && (ceiling == 0 || memoryLimit < ceiling)) {
+        ceiling = memoryLimit;
+    }
+    return ceiling;
+}
+
+bool BBbAlgorithm::nextLevelFits(size_t ceiling) const {
+    if (ceiling == 0) {
+        return true;
+    }
+    // Upper bound: two children per node, arenas at most twice their fill,
+    // and, when the level goes parallel, a second copy in the chunk buffers
+    // plus the node each chunk expands from.
+    size_t rows = 2 * current.size();
+    size_t rowBytes = (current.pointCount(0) + 4) * sizeof(int) + sizeof(size_t) + sizeof(uint64_t);
+    size_t levelBytes = 2 * rows * rowBytes;
+    if (threadCount > 1 && current.size() >= PARALLEL_LEVEL_MIN) {
+        levelBytes = 2 * levelBytes + chunkScratchBytes(chunkCountFor(current.size()));
+    }
+    return current.memoryBytes() + std::max(next.memoryBytes(), levelBytes) + depthFirstBytes() <= ceiling;
+}
+
+size_t BBbAlgorithm::chunkCountFor(size_t rows) const {
+    return std::max<size_t>(1, std::min(rows / 64, static_cast<size_t>(threadCount) * 4));
+}
+
+size_t BBbAlgorithm::chunkScratchBytes(size_t chunkCount) const {
+    // Each chunk expands from its own copy of the scratch node, and copies
+    // made for an earlier, wider level are kept for reuse.
+    size_t nodeBytes = scratch.D.memoryBytes() + (current.pointCount(0) + 1) * sizeof(int);
+    return std::max(chunkCount, chunks.size()) * nodeBytes;
+}
+
+size_t BBbAlgorithm::depthFirstBytes() const {
+    // Every node of a level has the same point and distance counts, and each
+    // placement consumes at least as many distances as there are points.
+    size_t distances = static_cast<size_t>(current.remaining(0));
+    size_t points = current.pointCount(0) + distances / current.pointCount(0) + 1;
+    return scratch.D.memoryBytes() + scratch.D.indexMemoryBytes()
+         + (distances + points) * sizeof(int) + points * sizeof(BBdSearch::Frame);
 }
 
-bool BBbAlgorithm::isSubset(const std::vector<int>& subset, const std::vector<int>& set) {
-    std::vector<int> temp = set;
-    for (int element : subset) {
-        auto it = std::find(temp.begin(), temp.end(), element);
-        if (it == temp.end()) {
+bool BBbAlgorithm::searchDepthFirst(BudgetGuard& guard, const SolutionCallback& onSolution) {
+    // The next level will not be built; give its arenas back before descending.
+    next = BBbFrontier();
+    for (size_t i = 0; i < current.size(); ++i) {
+        if (current.remaining(i) == 0) {
+            continue;
+        }
+        materialize(i, scratch);
+        depthFirst.seed(scratch.D, scratch.X);
+        if (!guard.trackMemory(current.memoryBytes() + depthFirst.memoryBytes())) {
+            return false;
+        }
+        while (depthFirst.runWithin(guard, stopFlag, stopCheck)) {
+            if (!onSolution(depthFirst.sortedPoints())) {
+                return false;
+            }
+        }
+        if (guard.exhausted() || stopped()) {
             return false;
         }
-        temp.erase(it);
     }
     return true;
 }
 
-std::vector<int> BBbAlgorithm::removeSubset(const std::vector<int>& set,
-                                            const std::vector<int>& subset)
-{
-    std::vector<int> result = set;
-    for (int element : subset) {
-        auto it = std::find(result.begin(), result.end(), element);
-        if (it != result.end()) {
-            result.erase(it);
-        }
+void BBbAlgorithm::addChild(Scratch& work, int y, BBbFrontier& out) {
+    if (!work.D.removeDeltas(y, work.X)) {
+        return;
+    }
+    if (lookahead && !Lookahead::nextPlacementPossible(work.D, work.X.data(), work.X.size(), y, work.X.back())) {
+        work.D.restoreDeltas(y, work.X);
+        return;
     }
-    return result;
+    out.pushUnique(work.X, y, work.D.size(), work.hash ^ Zobrist::key(y));
+    work.D.restoreDeltas(y, work.X);
 }
 
-void BBbAlgorithm::generateNextLevel(std::vector<std::vector<int>>& LD,
-                                     std::vector<std::vector<int>>& LX)
-{
-    std::vector<std::vector<int>> newLD;
-    std::vector<std::vector<int>> newLX;
-    std::set<std::vector<int>> uniqueX;
+void BBbAlgorithm::expandNode(size_t row, int width, Scratch& work, BBbFrontier& out) {
+    materialize(row, work);
+    int y = work.D.max();
+
+    addChild(work, y, out);
+
+    int complementY = width - y;
+    if (complementY != y && !Symmetry::isSelfMirror(work.X.data(), work.X.size())) {
+        addChild(work, complementY, out);
+    }
+}
 
-    for (size_t i = 0; i < LD.size(); ++i) {
-        if (LD[i].empty()) {
+bool BBbAlgorithm::generateNextLevel(int width, BudgetGuard& guard) {
+    if (threadCount > 1 && current.size() >= PARALLEL_LEVEL_MIN) {
+        return generateNextLevelParallel(width, guard);
+    }
+    next.reset();
+
+    for (size_t i = 0; i < current.size(); ++i) {
+        if (current.remaining(i) == 0) {
             continue;
         }
-        int y = *std::max_element(LD[i].begin(), LD[i].end());
-        int width = LX[i].back();
-
-        auto deltaY = calculateDelta(y, LX[i]);
-        if (isSubset(deltaY, LD[i])) {
-            std::vector<int> newX = LX[i];
-            newX.push_back(y);
-            std::sort(newX.begin(), newX.end());
-            if (uniqueX.find(newX) == uniqueX.end()) {
-                uniqueX.insert(newX);
-                auto newD = removeSubset(LD[i], deltaY);
-                newLD.push_back(newD);
-                newLX.push_back(newX);
-            }
+        if (!guard.expand() || stopped()) {
+            return false;
         }
+        expandNode(i, width, scratch, next);
+        if (!guard.trackMemory(current.memoryBytes() + next.memoryBytes())) {
+            return false;
+        }
+    }
+    current.swap(next);
+    return true;
+}
 
-        int complementY = width - y;
-        if (complementY != y) {
-            auto deltaC = calculateDelta(complementY, LX[i]);
-            if (isSubset(deltaC, LD[i])) {
-                std::vector<int> newX2 = LX[i];
-                newX2.push_back(complementY);
-                std::sort(newX2.begin(), newX2.end());
-                if (uniqueX.find(newX2) == uniqueX.end()) {
-                    uniqueX.insert(newX2);
-                    auto newD2 = removeSubset(LD[i], deltaC);
-                    newLD.push_back(newD2);
-                    newLX.push_back(newX2);
+bool BBbAlgorithm::generateNextLevelParallel(int width, BudgetGuard& guard) {
+    if (!pool) {
+        pool = std::make_unique<WorkStealingPool>(threadCount);
+    }
+    // Contiguous slices keep each chunk's children in sequential order, so the
+    // merged level (and the solution picked from it) matches the serial run.
+    size_t chunkCount = chunkCountFor(current.size());
+    size_t chunkSize = (current.size() + chunkCount - 1) / chunkCount;
+    if (chunks.size() < chunkCount) {
+        chunks.resize(chunkCount);
+    }
+    for (size_t c = 0; c < chunkCount; ++c) {
+        ExpansionChunk& chunk = chunks[c];
+        chunk.begin = std::min(current.size(), c * chunkSize);
+        chunk.end = std::min(current.size(), chunk.begin + chunkSize);
+        chunk.work.D = scratch.D;
+        chunk.work.X = scratch.X;
+        pool->submit([this, &chunk, &guard, width] {
+            chunk.children.reset();
+            for (size_t i = chunk.begin; i < chunk.end; ++i) {
+                if (current.remaining(i) == 0) {
+                    continue;
                 }
+                if (!guard.expand() || stopped()) {
+                    return;
+                }
+                expandNode(i, width, chunk.work, chunk.children);
+            }
+        });
+    }
+    pool->wait();
+    if (guard.exhausted() || stopped()) {
+        return false;
+    }
+
+    size_t bytes = current.memoryBytes() + chunkScratchBytes(chunkCount);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        bytes += chunks[c].children.memoryBytes();
+    }
+    if (!guard.trackMemory(bytes)) {
+        return false;
+    }
+
+    // Children may repeat across chunks: each shard owns a slice of the
+    // fingerprint space and keeps the first occurrence in chunk order.
+    size_t shardCount = static_cast<size_t>(threadCount);
+    if (shards.size() < shardCount) {
+        shards.resize(shardCount);
+    }
+    for (size_t c = 0; c < chunkCount; ++c) {
+        chunks[c].keep.assign(chunks[c].children.size(), 1);
+    }
+    for (size_t s = 0; s < shardCount; ++s) {
+        pool->submit([this, s, shardCount, chunkCount] { dedupShard(s, shardCount, chunkCount); });
+    }
+    pool->wait();
+    for (size_t c = 0; c < chunkCount; ++c) {
+        pool->submit([this, c, shardCount] { dropMirrors(c, shardCount); });
+    }
+    pool->wait();
+
+    size_t rows = 0;
+    size_t points = 0;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        ExpansionChunk& chunk = chunks[c];
+        chunk.rowBase = rows;
+        chunk.pointBase = points;
+        for (size_t r = 0; r < chunk.children.size(); ++r) {
+            if (chunk.keep[r]) {
+                ++rows;
+                points += chunk.children.pointCount(r);
             }
         }
     }
-    LD = std::move(newLD);
-    LX = std::move(newLX);
-}
+    next.reset();
+    next.prepareRows(rows, points);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        pool->submit([this, c] {
+            ExpansionChunk& chunk = chunks[c];
+            size_t row = chunk.rowBase;
+            size_t pointOffset = chunk.pointBase;
+            for (size_t r = 0; r < chunk.children.size(); ++r) {
+                if (chunk.keep[r]) {
+                    next.setRow(row++, pointOffset, chunk.children, r);
+                    pointOffset += chunk.children.pointCount(r);
+                }
+            }
+        });
+    }
+    pool->wait();
 
-void BBbAlgorithm::generateNextLevelPartial(std::vector<std::vector<int>>& LD,
-                                            std::vector<std::vector<int>>& LX,
-                                            int width)
-{
-    std::vector<std::vector<int>> newLD;
-    std::vector<std::vector<int>> newLX;
-    std::set<std::vector<int>> uniqueX;
+    if (!guard.trackMemory(bytes + next.memoryBytes())) {
+        return false;
+    }
+    current.swap(next);
+    return true;
+}
 
-    for (size_t i = 0; i < LD.size(); i++) {
-        if (LD[i].empty()) {
+void BBbAlgorithm::dropMirrors(size_t chunk, size_t shardCount) {
+    // Serial expansion rejects a child whose mirror was pushed before it.
+    // Shard tables hold the first occurrence of every child, so look the
+    // mirror up there and keep the child unless that occurrence comes first.
+    ExpansionChunk& own = chunks[chunk];
+    const BBbFrontier& children = own.children;
+    for (size_t r = 0; r < children.size(); ++r) {
+        const int* p = children.points(r);
+        size_t count = children.pointCount(r);
+        if (!own.keep[r] || Symmetry::isSelfMirror(p, count)) {
             continue;
         }
-        int y = *std::max_element(LD[i].begin(), LD[i].end());
-
-        auto deltaY = calculateDelta(y, LX[i]);
-        if (isSubset(deltaY, LD[i])) {
-            std::vector<int> newX = LX[i];
-            newX.push_back(y);
-            std::sort(newX.begin(), newX.end());
-            if (uniqueX.find(newX) == uniqueX.end()) {
-                uniqueX.insert(newX);
-                auto newD = removeSubset(LD[i], deltaY);
-                newLD.push_back(newD);
-                newLX.push_back(newX);
+        uint64_t mirror = Symmetry::mirrorFingerprint(p, count, p[count - 1]);
+        const std::vector<uint64_t>& table = shards[(mirror >> 32) % shardCount];
+        size_t mask = table.size() - 1;
+        for (size_t bucket = static_cast<size_t>(mirror) & mask; table[bucket] != 0; bucket = (bucket + 1) & mask) {
+            uint64_t entry = table[bucket] - 1;
+            size_t otherChunk = static_cast<size_t>(entry >> 32);
+            size_t otherRow = static_cast<size_t>(entry & 0xFFFFFFFFu);
+            const BBbFrontier& other = chunks[otherChunk].children;
+            if (other.fingerprint(otherRow) == mirror && other.pointCount(otherRow) == count &&
+                Symmetry::isMirrorOf(p, other.points(otherRow), count)) {
+                if (otherChunk < chunk || (otherChunk == chunk && otherRow < r)) {
+                    own.keep[r] = 0;
+                }
+                break;
             }
         }
+    }
+}
 
-        int complement = width - y;
-        if (complement != y) {
-            auto deltaC = calculateDelta(complement, LX[i]);
-            if (isSubset(deltaC, LD[i])) {
-                std::vector<int> newX2 = LX[i];
-                newX2.push_back(complement);
-                std::sort(newX2.begin(), newX2.end());
-                if (uniqueX.find(newX2) == uniqueX.end()) {
-                    uniqueX.insert(newX2);
-                    auto newD2 = removeSubset(LD[i], deltaC);
-                    newLD.push_back(newD2);
-                    newLX.push_back(newX2);
+void BBbAlgorithm::dedupShard(size_t shard, size_t shardCount, size_t chunkCount) {
+    size_t members = 0;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        const BBbFrontier& children = chunks[c].children;
+        for (size_t r = 0; r < children.size(); ++r) {
+            members += (children.fingerprint(r) >> 32) % shardCount == shard;
+        }
+    }
+    size_t capacity = 16;
+    while (capacity < members * 2) {
+        capacity *= 2;
+    }
+    // Entries are (chunk << 32 | row) + 1; zero marks a free bucket.
+    std::vector<uint64_t>& table = shards[shard];
+    table.assign(capacity, 0);
+    size_t mask = capacity - 1;
+
+    for (size_t c = 0; c < chunkCount; ++c) {
+        const BBbFrontier& children = chunks[c].children;
+        for (size_t r = 0; r < children.size(); ++r) {
+            uint64_t fingerprint = children.fingerprint(r);
+            if ((fingerprint >> 32) % shardCount != shard) {
+                continue;
+            }
+            size_t bucket = static_cast<size_t>(fingerprint) & mask;
+            bool duplicate = false;
+            while (table[bucket] != 0) {
+                uint64_t entry = table[bucket] - 1;
+                const BBbFrontier& other = chunks[static_cast<size_t>(entry >> 32)].children;
+                size_t otherRow = static_cast<size_t>(entry & 0xFFFFFFFFu);
+                if (other.fingerprint(otherRow) == fingerprint &&
+                    std::equal(children.points(r), children.points(r) + children.pointCount(r),
+                               other.points(otherRow), other.points(otherRow) + other.pointCount(otherRow))) {
+                    duplicate = true;
+                    break;
                 }
+                bucket = (bucket + 1) & mask;
+            }
+            if (duplicate) {
+                chunks[c].keep[r] = 0;
+            } else {
+                table[bucket] = ((static_cast<uint64_t>(c) << 32) | r) + 1;
             }
         }
     }
-    LD = std::move(newLD);
-    LX = std::move(newLX);
 }
@@ -0,0 +1,132 @@
+#include "../../include/algorithms/bbb_frontier.h"
+#include "../../include/zobrist.h"
+#include "../../include/symmetry.h"
+#include <algorithm>
+#include <utility>
+
+void BBbFrontier::reset() {
+    remainingCounts.clear();
+    pointArena.clear();
+    pointOffsets.assign(1, 0);
+    fingerprints.clear();
+    std::fill(table.begin(), table.end(), -1);
+}
+
+void BBbFrontier::swap(BBbFrontier& other) noexcept {
+    remainingCounts.swap(other.remainingCounts);
+    pointArena.swap(other.pointArena);
+    pointOffsets.swap(other.pointOffsets);
+    fingerprints.swap(other.fingerprints);
+    table.swap(other.table);
+    std::swap(tableMask, other.tableMask);
+}
+
+std::vector<int> BBbFrontier::pointsOf(size_t row) const {
+    return std::vector<int>(points(row), points(row) + pointCount(row));
+}
+
+void BBbFrontier::push(const std::vector<int>& X, int remaining) {
+    remainingCounts.push_back(remaining);
+    pointArena.insert(pointArena.end(), X.begin(), X.end());
+    pointOffsets.push_back(pointArena.size());
+    fingerprints.push_back(Zobrist::ofPoints(X.data(), X.size()));
+}
+
+bool BBbFrontier::pushUnique(const std::vector<int>& X, int y, int remaining, uint64_t fingerprint) {
+    if ((size() + 1) * 2 > table.size()) {
+        growTable();
+    }
+    pushRow(X, y, remaining);
+    fingerprints.push_back(fingerprint);
+    size_t row = size() - 1;
+
+    size_t bucket = static_cast<size_t>(fingerprint) & tableMask;
+    while (table[bucket] >= 0) {
+        size_t other = static_cast<size_t>(table[bucket]);
+        if (fingerprints[other] == fingerprint && samePoints(other, row)) {
+            popBack();
+            return false;
+        }
+        bucket = (bucket + 1) & tableMask;
+    }
+    if (hasMirror(row)) {
+        popBack();
+        return false;
+    }
+    table[bucket] = static_cast<int>(row);
+    return true;
+}
+
+bool BBbFrontier::hasMirror(size_t row) const {
+    const int* p = points(row);
+    size_t count = pointCount(row);
+    if (Symmetry::isSelfMirror(p, count)) {
+        return false;
+    }
+    uint64_t mirror = Symmetry::mirrorFingerprint(p, count, p[count - 1]);
+    for (size_t bucket = static_cast<size_t>(mirror) & tableMask; table[bucket] >= 0;
+         bucket = (bucket + 1) & tableMask) {
+        size_t other = static_cast<size_t>(table[bucket]);
+        if (fingerprints[other] == mirror && pointCount(other) == count &&
+            Symmetry::isMirrorOf(p, points(other), count)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BBbFrontier::pushRow(const std::vector<int>& X, int y, int remaining) {
+    remainingCounts.push_back(remaining);
+    auto split = std::lower_bound(X.begin(), X.end(), y);
+    pointArena.insert(pointArena.end(), X.begin(), split);
+    pointArena.push_back(y);
+    pointArena.insert(pointArena.end(), split, X.end());
+    pointOffsets.push_back(pointArena.size());
+}
+
+void BBbFrontier::popBack() {
+    remainingCounts.pop_back();
+    pointOffsets.pop_back();
+    pointArena.resize(pointOffsets.back());
+    fingerprints.pop_back();
+}
+
+bool BBbFrontier::samePoints(size_t a, size_t b) const {
+    return pointCount(a) == pointCount(b) &&
+           std::equal(points(a), points(a) + pointCount(a), points(b));
+}
+
+void BBbFrontier::growTable() {
+    size_t capacity = std::max<size_t>(64, table.size() * 2);
+    table.assign(capacity, -1);
+    tableMask = capacity - 1;
+    for (size_t row = 0; row < size(); ++row) {
+        size_t bucket = static_cast<size_t>(fingerprints[row]) & tableMask;
+        while (table[bucket] >= 0) {
+            bucket = (bucket + 1) & tableMask;
+        }
+        table[bucket] = static_cast<int>(row);
+    }
+}
+
+void BBbFrontier::prepareRows(size_t rows, size_t totalPoints) {
+    remainingCounts.resize(rows);
+    pointArena.resize(totalPoints);
+    pointOffsets.resize(rows + 1);
+    pointOffsets[0] = 0;
+    fingerprints.resize(rows);
+}
+
+void BBbFrontier::setRow(size_t row, size_t pointOffset, const BBbFrontier& source, size_t sourceRow) {
+    remainingCounts[row] = source.remaining(sourceRow);
+    fingerprints[row] = source.fingerprint(sourceRow);
+    size_t count = source.pointCount(sourceRow);
+    std::copy(source.points(sourceRow), source.points(sourceRow) + count,
+              pointArena.begin() + static_cast<std::ptrdiff_t>(pointOffset));
+    pointOffsets[row + 1] = pointOffset + count;
+}
+
+size_t BBbFrontier::memoryBytes() const {
+    return (remainingCounts.capacity() + pointArena.capacity() + table.capacity()) * sizeof(int)
+         + pointOffsets.capacity() * sizeof(size_t) + fingerprints.capacity() * sizeof(uint64_t);
+}
@@ -1,89 +1,175 @@
 #include "../../include/algorithms/bbd_algorithm.h"
+#include "../../include/work_stealing_pool.h"
 
 std::optional<std::vector<int>> BBdAlgorithm::solve(std::vector<int> D) {
-    if (D.empty()) return std::nullopt;
+    return solve(std::move(D), SearchBudget{}).solution;
+}
+
+SolveResult BBdAlgorithm::solve(std::vector<int> D, const SearchBudget& budget) {
+    BudgetGuard guard(budget);
+    if (D.empty()) return guard.finish(std::nullopt);
 
     std::sort(D.begin(), D.end(), std::greater<int>());
     int width = D.front();
+    D.erase(D.begin());
+    search.build(D, width);
+    return solveLoaded(guard);
+}
 
-    std::vector<int> X0 = {0, width};
+SolveResult BBdAlgorithm::solvePartial(const std::vector<int>& placed,
+                                       const DistanceMultiset& remaining,
+                                       const SearchBudget& budget)
+{
+    BudgetGuard guard(budget);
+    search.seed(remaining, placed);
+    return solveLoaded(guard);
+}
 
-    auto it = std::find(D.begin(), D.end(), width);
-    if (it != D.end()) {
-        D.erase(it);
+SolveResult BBdAlgorithm::solveLoaded(BudgetGuard& guard) {
+    prepare(search);
+    if (threadCount > 1) {
+        return solveParallel(guard);
     }
-
-    Node root(D, X0, 0);
-    return place(root);
+    std::span<const BBdSearch> searches(&search, 1);
+    if (!guard.trackMemory(search.memoryBytes() + transpositions.memoryBytes()) || !search.runWithin(guard)) {
+        return finish(guard, std::nullopt, searches);
+    }
+    return finish(guard, search.sortedPoints(), searches);
 }
 
-std::vector<int> BBdAlgorithm::calculateDelta(int y, const std::vector<int>& X) {
-    std::vector<int> delta;
-    delta.reserve(X.size());
-    for (int x : X) {
-        delta.push_back(std::abs(y - x));
+EnumerationResult BBdAlgorithm::enumerate(std::vector<int> D,
+                                          SolutionCallback onSolution,
+                                          const EnumerationOptions& options)
+{
+    SolutionSink sink(std::move(onSolution), options);
+    if (D.empty()) {
+        return sink.finish(true);
     }
-    return delta;
+    std::sort(D.begin(), D.end(), std::greater<int>());
+    int width = D.front();
+    D.erase(D.begin());
+    search.build(D, width);
+    return enumerateLoaded(sink);
 }
 
-bool BBdAlgorithm::isSubset(const std::vector<int>& subset, const std::vector<int>& set) {
-    std::vector<int> temp = set;
-    for (int element : subset) {
-        auto it = std::find(temp.begin(), temp.end(), element);
-        if (it == temp.end()) {
-            return false;
+EnumerationResult BBdAlgorithm::enumeratePartial(const std::vector<int>& placed,
+                                                 const DistanceMultiset& remaining,
+                                                 SolutionCallback onSolution,
+                                                 const EnumerationOptions& options)
+{
+    SolutionSink sink(std::move(onSolution), options);
+    search.seed(remaining, placed);
+    return enumerateLoaded(sink);
+}
+
+EnumerationResult BBdAlgorithm::enumerateLoaded(SolutionSink& sink) {
+    prepare(search);
+    while (true) {
+        auto status = search.run(ENUMERATION_CHECK_INTERVAL);
+        if (status == BBdSearch::Status::EXHAUSTED) {
+            return sink.finish(true);
+        }
+        if (status == BBdSearch::Status::FOUND) {
+            if (!sink.offer(search.sortedPoints())) {
+                return sink.finish(false);
+            }
+        } else if (sink.shouldStop()) {
+            return sink.finish(false);
         }
-        temp.erase(it);
     }
-    return true;
 }
 
-std::vector<int> BBdAlgorithm::removeSubset(const std::vector<int>& set, const std::vector<int>& subset) {
-    std::vector<int> result = set;
-    for (int element : subset) {
-        auto it = std::find(result.begin(), result.end(), element);
-        if (it != result.end()) {
-            result.erase(it);
+SolveResult BBdAlgorithm::solveParallel(BudgetGuard& guard) {
+    ParallelContext ctx;
+    ctx.guard = &guard;
+    ctx.splitDepth = splitDepth;
+    if (ctx.splitDepth == 0) {
+        // Aim for a few dozen tasks per worker so stealing can even out the load.
+        while ((1 << ctx.splitDepth) < threadCount * 32 && ctx.splitDepth < 20) {
+            ++ctx.splitDepth;
         }
     }
-    return result;
+
+    ctx.workerSearch.assign(static_cast<size_t>(threadCount), search);
+    if (!guard.trackMemory(search.memoryBytes() * static_cast<size_t>(threadCount) + transpositions.memoryBytes())) {
+        return finish(guard, std::nullopt, ctx.workerSearch);
+    }
+
+    WorkStealingPool pool(threadCount);
+    ctx.pool = &pool;
+    pool.submit([this, &ctx] { runTask(ctx, {}); });
+    pool.wait();
+    return finish(guard, std::move(ctx.solution), ctx.workerSearch);
 }
 
-std::optional<std::vector<int>> BBdAlgorithm::place(Node& current) {
-    if (current.D.empty()) {
-        return current.X;
+void BBdAlgorithm::runTask(ParallelContext& ctx, const std::vector<int>& prefix) {
+    if (ctx.found.load(std::memory_order_relaxed) || ctx.guard->exhausted()) {
+        return;
     }
-    int y = *std::max_element(current.D.begin(), current.D.end());
-    int width = current.X.back();
-
-    // Try y
-    auto deltaY = calculateDelta(y, current.X);
-    if (isSubset(deltaY, current.D)) {
-        std::vector<int> newX = current.X;
-        newX.push_back(y);
-        std::sort(newX.begin(), newX.end());
-        std::vector<int> newD = removeSubset(current.D, deltaY);
-
-        Node next(newD, newX, current.level + 1);
-        if (auto result = place(next)) {
-            return result;
+    BBdSearch& worker = ctx.workerSearch[static_cast<size_t>(ctx.pool->currentWorker())];
+    worker.rewind();
+    for (int y : prefix) {
+        // Only fails when another worker has since proven this prefix dead.
+        if (!worker.applyPlacement(y)) {
+            return;
         }
     }
 
-    int complement = width - y;
-    if (complement != y) {
-        auto deltaC = calculateDelta(complement, current.X);
-        if (isSubset(deltaC, current.D)) {
-            std::vector<int> newX2 = current.X;
-            newX2.push_back(complement);
-            std::sort(newX2.begin(), newX2.end());
-            std::vector<int> newD2 = removeSubset(current.D, deltaC);
-
-            Node next2(newD2, newX2, current.level + 1);
-            if (auto result2 = place(next2)) {
-                return result2;
-            }
+    if (static_cast<int>(prefix.size()) >= ctx.splitDepth) {
+        if (worker.runWithin(*ctx.guard, &ctx.found)) {
+            recordSolution(ctx, worker);
+        }
+        return;
+    }
+    if (worker.done()) {
+        recordSolution(ctx, worker);
+        return;
+    }
+    if (!ctx.guard->expand()) {
+        return;
+    }
+
+    int y = worker.nextDistance();
+    int complement = worker.getWidth() - y;
+    int branches[2] = {y, complement};
+    int branchCount = (complement != y && !worker.selfMirror()) ? 2 : 1;
+    // Submitted in reverse so the owner pops the y branch first, as in the serial order.
+    for (int b = branchCount - 1; b >= 0; --b) {
+        int branch = branches[b];
+        if (worker.applyPlacement(branch)) {
+            worker.undoPlacement();
+            std::vector<int> childPrefix = prefix;
+            childPrefix.push_back(branch);
+            ctx.pool->submit([this, &ctx, childPrefix] { runTask(ctx, childPrefix); });
         }
     }
-    return std::nullopt;
+}
+
+void BBdAlgorithm::recordSolution(ParallelContext& ctx, const BBdSearch& worker) {
+    std::lock_guard<std::mutex> lock(ctx.solutionMutex);
+    if (!ctx.solution) {
+        ctx.solution = worker.sortedPoints();
+    }
+    ctx.found.store(true, std::memory_order_relaxed);
+}
+
+void BBdAlgorithm::prepare(BBdSearch& root) {
+    root.setLookahead(lookahead);
+    if (transpositions.enabled()) {
+        transpositions.clear();
+        root.setTranspositionTable(&transpositions);
+    } else {
+        root.setTranspositionTable(nullptr);
+    }
+}
+
+SolveResult BBdAlgorithm::finish(const BudgetGuard& guard, std::optional<std::vector<int>> solution,
+                                 std::span<const BBdSearch> searches)
+{
+    SolveResult result = guard.finish(std::move(solution));
+    for (const BBdSearch& s : searches) {
+        result.stats.transpositionHits += s.tableHits();
+        result.stats.transpositionMisses += s.tableMisses();
+    }
+    return result;
 }
@@ -0,0 +1,240 @@
+#include "../../include/algorithms/bbd_search.h"
+#include "../../include/symmetry.h"
+#include "../../include/zobrist.h"
+#include "../../include/algorithms/lookahead.h"
+#include <algorithm>
+#include <cmath>
+
+BBdSearch::BBdSearch(std::vector<int> D) {
+    if (D.empty()) {
+        currentStatus = Status::EXHAUSTED;
+        return;
+    }
+    auto it = std::max_element(D.begin(), D.end());
+    int totalWidth = *it;
+    D.erase(it);
+    build(D, totalWidth);
+}
+
+void BBdSearch::build(const std::vector<int>& distances, int totalWidth) {
+    width = totalWidth;
+    remainingD = DistanceMultiset(distances);
+    X.assign({0, width});
+    markPoints();
+    hashPoints();
+    reserveFor(distances.size());
+}
+
+void BBdSearch::seed(const DistanceMultiset& remaining, const std::vector<int>& placed) {
+    width = placed.back();
+    remainingD = remaining;
+    X = placed;
+    markPoints();
+    hashPoints();
+    reserveFor(static_cast<size_t>(remaining.size()));
+}
+
+void BBdSearch::markPoints() {
+    placedBits.assign(static_cast<size_t>(width) / 64 + 1, 0);
+    for (int x : X) {
+        flipPlaced(x);
+    }
+    unmatchedPoints = 0;
+    for (int x : X) {
+        unmatchedPoints += placed(width - x) ? 0 : 1;
+    }
+}
+
+void BBdSearch::hashPoints() {
+    pointsHash = Zobrist::ofPoints(X.data(), X.size());
+    mirrorHash = Symmetry::mirrorFingerprint(X.data(), X.size(), width);
+}
+
+void BBdSearch::reserveFor(size_t distances) {
+    // Every placement consumes |X| distances, which bounds the depth of the search.
+    size_t maxPoints = X.size();
+    size_t budget = distances;
+    while (budget >= maxPoints) {
+        budget -= maxPoints;
+        ++maxPoints;
+    }
+    X.reserve(maxPoints);
+    frames.clear();
+    frames.reserve(maxPoints);
+    baseDepth = 0;
+    solvedDepth = 0;
+    nodes = 0;
+    hits = 0;
+    misses = 0;
+    currentStatus = Status::READY;
+}
+
+bool BBdSearch::applyPlacement(int y) {
+    currentStatus = Status::READY;
+    return push(y, Branch::FIXED);
+}
+
+void BBdSearch::undoPlacement() {
+    currentStatus = Status::READY;
+    pop();
+}
+
+void BBdSearch::rewind() {
+    while (!frames.empty()) {
+        pop();
+    }
+    currentStatus = Status::READY;
+}
+
+std::vector<int> BBdSearch::sortedPoints() const {
+    std::vector<int> sorted = X;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+size_t BBdSearch::memoryBytes() const {
+    return remainingD.memoryBytes() + remainingD.indexMemoryBytes()
+         + X.capacity() * sizeof(int)
+         + placedBits.capacity() * sizeof(uint64_t)
+         + frames.capacity() * sizeof(Frame);
+}
+
+bool BBdSearch::push(int y, Branch branch) {
+    uint64_t childHash = 0;
+    uint64_t childMirror = 0;
+    if (table) {
+        childHash = pointsHash ^ Zobrist::key(y);
+        childMirror = mirrorHash ^ Zobrist::key(width - y);
+        if (table->contains(std::min(childHash, childMirror))) {
+            ++hits;
+            return false;
+        }
+        ++misses;
+    }
+    // Sites are distinct, so a point is never placed twice; this also
+    // keeps a zero distance in D from placing one.
+    if (placed(y) || !remainingD.removeDeltas(y, X)) {
+        return false;
+    }
+    if (lookahead && !Lookahead::nextPlacementPossible(remainingD, X.data(), X.size(), y, width)) {
+        remainingD.restoreDeltas(y, X);
+        return false;
+    }
+    frames.push_back(Frame{y, branch});
+    unmatchedPoints += unmatchedDelta(y);
+    flipPlaced(y);
+    X.push_back(y);
+    if (table) {
+        pointsHash = childHash;
+        mirrorHash = childMirror;
+    }
+    return true;
+}
+
+void BBdSearch::pop() {
+    int y = frames.back().y;
+    X.pop_back();
+    flipPlaced(y);
+    unmatchedPoints -= unmatchedDelta(y);
+    if (table) {
+        pointsHash ^= Zobrist::key(y);
+        mirrorHash ^= Zobrist::key(width - y);
+    }
+    remainingD.restoreDeltas(y, X);
+    frames.pop_back();
+    solvedDepth = std::min(solvedDepth, frames.size());
+}
+
+// Backtracking is chronological on purpose. The branch point of a state is
+// its largest remaining distance, and the placement just above it either used
+// up the last copy of the previous largest distance or placed that same
+// distance again, which clashes with it. Every dead end therefore depends on
+// the level right above it, so conflict-directed backjumping would always
+// land where plain backtracking does.
+bool BBdSearch::backtrack() {
+    while (frames.size() > baseDepth) {
+        Frame last = frames.back();
+        // Both branches below this state are done; unless one led to a
+        // solution, the state is dead however it is reached.
+        if (table && frames.size() > solvedDepth) {
+            table->insert(std::min(pointsHash, mirrorHash));
+        }
+        pop();
+        if (last.branch == Branch::DISTANCE && !selfMirror()) {
+            int complement = width - last.y;
+            if (complement != last.y && push(complement, Branch::COMPLEMENT)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+BBdSearch::Status BBdSearch::run(uint64_t maxNodes, const std::atomic<bool>* stop) {
+    switch (currentStatus) {
+        case Status::READY:
+            baseDepth = frames.size();
+            break;
+        case Status::FOUND:
+            // Resuming after a solution continues with the next branch.
+            if (!backtrack()) {
+                return currentStatus = Status::EXHAUSTED;
+            }
+            break;
+        case Status::EXHAUSTED:
+            return currentStatus;
+        default:
+            break;
+    }
+
+    uint64_t budget = maxNodes;
+    while (true) {
+        if (remainingD.empty()) {
+            solvedDepth = frames.size();
+            return currentStatus = Status::FOUND;
+        }
+        if (budget == 0) {
+            return currentStatus = Status::PAUSED;
+        }
+        if (stop && stop->load(std::memory_order_relaxed)) {
+            return currentStatus = Status::STOPPED;
+        }
+        --budget;
+        ++nodes;
+
+        int y = remainingD.max();
+        if (push(y, Branch::DISTANCE)) {
+            continue;
+        }
+        int complement = width - y;
+        if (complement != y && !selfMirror() && push(complement, Branch::COMPLEMENT)) {
+            continue;
+        }
+        if (!backtrack()) {
+            return currentStatus = Status::EXHAUSTED;
+        }
+    }
+}
+
+bool BBdSearch::runWithin(BudgetGuard& guard, const std::atomic<bool>* stop,
+                          const std::function<bool()>* shouldStop)
+{
+    while (guard.poll()) {
+        uint64_t chunk = std::min(BudgetGuard::CHECK_INTERVAL, guard.nodesLeft());
+        if (chunk == 0) {
+            // The next node would go over the node budget.
+            guard.expand();
+            return false;
+        }
+        uint64_t before = nodes;
+        Status result = run(chunk, stop);
+        guard.expand(nodes - before);
+        if (result == Status::FOUND) {
+            return true;
+        }
+        if (result != Status::PAUSED || (shouldStop && (*shouldStop)())) {
+            return false;
+        }
+    }
+    return false;
+}
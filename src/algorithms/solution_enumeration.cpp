@@ -0,0 +1,48 @@
+#include "../../include/algorithms/solution_enumeration.h"
+#include <algorithm>
+
+SolutionSink::SolutionSink(SolutionCallback callback, const EnumerationOptions& options)
+    : onSolution(std::move(callback)), limits(options)
+{
+    deadline = std::chrono::steady_clock::now() + limits.timeLimit;
+}
+
+std::vector<int> SolutionSink::canonical(const std::vector<int>& sortedPoints) {
+    if (sortedPoints.empty()) {
+        return sortedPoints;
+    }
+    int width = sortedPoints.back();
+    std::vector<int> mirror;
+    mirror.reserve(sortedPoints.size());
+    for (auto it = sortedPoints.rbegin(); it != sortedPoints.rend(); ++it) {
+        mirror.push_back(width - *it);
+    }
+    return std::min(sortedPoints, mirror);
+}
+
+bool SolutionSink::offer(const std::vector<int>& sortedPoints) {
+    if (stopped) {
+        return false;
+    }
+    if (seen.insert(canonical(sortedPoints)).second) {
+        ++reported;
+        if (onSolution && !onSolution(sortedPoints)) {
+            stopped = true;
+        }
+        if (limits.maxSolutions > 0 && reported >= limits.maxSolutions) {
+            stopped = true;
+        }
+    }
+    return !shouldStop();
+}
+
+bool SolutionSink::shouldStop() const {
+    if (stopped) {
+        return true;
+    }
+    return limits.timeLimit.count() > 0 && std::chrono::steady_clock::now() >= deadline;
+}
+
+EnumerationResult SolutionSink::finish(bool exhausted) const {
+    return EnumerationResult{reported, exhausted && !stopped};
+}
@@ -0,0 +1,67 @@
+#include "../../include/algorithms/transposition_table.h"
+
+void TranspositionTable::configure(size_t maxBytes) {
+    size_t buckets = 0;
+    if (maxBytes >= BUCKET_SLOTS * sizeof(std::atomic<uint64_t>)) {
+        buckets = 1;
+        while (buckets * 2 * BUCKET_SLOTS * sizeof(std::atomic<uint64_t>) <= maxBytes) {
+            buckets *= 2;
+        }
+    }
+    slotCount = buckets * BUCKET_SLOTS;
+    bucketMask = buckets > 0 ? buckets - 1 : 0;
+    slots = slotCount > 0 ? std::make_unique<std::atomic<uint64_t>[]>(slotCount) : nullptr;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < slotCount; ++i) {
+        slots[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::contains(uint64_t key) {
+    if (!slots) {
+        return false;
+    }
+    uint64_t tag = tagOf(key);
+    std::atomic<uint64_t>* bucket = bucketOf(key);
+    for (size_t i = 0; i < BUCKET_SLOTS; ++i) {
+        uint64_t entry = bucket[i].load(std::memory_order_relaxed);
+        if ((entry & ~1ULL) == tag) {
+            if ((entry & 1ULL) == 0) {
+                bucket[i].fetch_or(1ULL, std::memory_order_relaxed);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::insert(uint64_t key) {
+    if (!slots) {
+        return;
+    }
+    uint64_t tag = tagOf(key);
+    std::atomic<uint64_t>* bucket = bucketOf(key);
+    for (size_t i = 0; i < BUCKET_SLOTS; ++i) {
+        uint64_t entry = bucket[i].load(std::memory_order_relaxed);
+        if ((entry & ~1ULL) == tag) {
+            return;
+        }
+        if (entry == 0 && bucket[i].compare_exchange_strong(entry, tag, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    // Two sweeps: the first clears reference bits it passes, so the second
+    // always finds a victim unless other threads keep touching the bucket.
+    for (size_t step = 0; step < 2 * BUCKET_SLOTS; ++step) {
+        std::atomic<uint64_t>& slot = bucket[step % BUCKET_SLOTS];
+        uint64_t entry = slot.load(std::memory_order_relaxed);
+        if (entry & 1ULL) {
+            slot.fetch_and(~1ULL, std::memory_order_relaxed);
+        } else if (slot.compare_exchange_strong(entry, tag, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
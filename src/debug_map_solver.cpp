@@ -22,9 +22,7 @@ DebugMapSolver::DebugMapSolver(
     maxind = static_cast<int>((1 + std::sqrt(1.0 + 8.0 * distances.size())) / 2);
     currentMap.resize(static_cast<size_t>(maxind), -1);
 
-    for (int d : distances) {
-        distanceCounter[d]++;
-    }
+    distanceCounter = DistanceMultiset(distances);
 
     stats.totalPaths      = 0;
     stats.processedPaths  = 0;
@@ -44,7 +42,18 @@ DebugMapSolver::DebugMapSolver(
     }
 }
 
+size_t DebugMapSolver::memoryBytes() const {
+    return (distances.capacity() + currentMap.capacity()) * sizeof(int)
+         + distanceCounter.memoryBytes() + distanceCounter.indexMemoryBytes();
+}
+
 std::optional<std::vector<int>> DebugMapSolver::solve() {
+    return solve(SearchBudget{}).solution;
+}
+
+SolveResult DebugMapSolver::solve(const SearchBudget& budget) {
+    BudgetGuard budgetGuard(budget);
+    guard = &budgetGuard;
     auto startTime = std::chrono::steady_clock::now();
     currentMap[0] = 0;
     if (maxind > 0) {
@@ -52,7 +61,10 @@ std::optional<std::vector<int>> DebugMapSolver::solve() {
     }
 
     bool foundSolution = false;
-    searchSolver(1, foundSolution);
+    if (budgetGuard.trackMemory(memoryBytes())) {
+        searchSolver(1, foundSolution);
+    }
+    guard = nullptr;
 
     auto endTime = std::chrono::steady_clock::now();
     stats.searchTimeMs = static_cast<double>(
@@ -68,19 +80,21 @@ std::optional<std::vector<int>> DebugMapSolver::solve() {
                 logFile << val << " ";
             }
             logFile << "\n";
+        } else if (budgetGuard.exhausted()) {
+            logFile << "Search stopped: budget exceeded.\n";
         } else {
             logFile << "No solution found.\n";
         }
     }
     if (stats.solutionFound) {
-        return stats.solution;
+        return budgetGuard.finish(stats.solution);
     }
-    return std::nullopt;
+    return budgetGuard.finish(std::nullopt);
 }
 
 void DebugMapSolver::searchSolver(int ind, bool& foundSolution) {
     ++debugDepth;
-    if (foundSolution) {
+    if (foundSolution || (guard && !guard->expand())) {
         --debugDepth;
         return;
     }
@@ -127,7 +141,7 @@ void DebugMapSolver::searchSolver(int ind, bool& foundSolution) {
         endVal = startVal;
     }
 
-    for (int pos = startVal; pos <= endVal && !foundSolution; ++pos) {
+    for (int pos = startVal; pos <= endVal && !foundSolution && !(guard && guard->exhausted()); ++pos) {
         currentMap[static_cast<size_t>(ind)] = pos;
         analyzeSolutionAttempt(ind, pos);
         if (isValidPartialSolution(ind + 1)) {
@@ -142,7 +156,7 @@ void DebugMapSolver::searchSolver(int ind, bool& foundSolution) {
 
 bool DebugMapSolver::isValidPartialSolution(int assignedCount) {
     if (assignedCount <= 1) return true;
-    std::map<int, int> usedDistances;
+    DistanceMultiset unusedDistances = distanceCounter;
     for (int i = 0; i < assignedCount; ++i) {
         if (currentMap[static_cast<size_t>(i)] == -1) {
             continue;
@@ -153,9 +167,7 @@ bool DebugMapSolver::isValidPartialSolution(int assignedCount) {
             }
             int distanceVal = std::abs(currentMap[static_cast<size_t>(i)] -
                                        currentMap[static_cast<size_t>(j)]);
-            usedDistances[distanceVal]++;
-            auto it = distanceCounter.find(distanceVal);
-            if (it == distanceCounter.end() || usedDistances[distanceVal] > it->second) {
+            if (!unusedDistances.remove(distanceVal)) {
                 return false;
             }
         }
@@ -216,8 +228,9 @@ void DebugMapSolver::logMapState(const std::string& message) {
 void DebugMapSolver::logDistanceConstraints() {
     if (!debugToFile) return;
     logFile << getIndentation() << "Distance usage:\n";
-    for (const auto& [distVal, count] : distanceCounter) {
-        logFile << getIndentation() << "  " << distVal << ": " << count << "\n";
+    for (int slot = 0; slot < distanceCounter.distinctCount(); ++slot) {
+        logFile << getIndentation() << "  " << distanceCounter.valueAt(slot) << ": "
+                << distanceCounter.countAt(slot) << "\n";
     }
 }
 
@@ -229,7 +242,7 @@ std::vector<std::pair<int, int>> DebugMapSolver::findConflictingPairs() const {
             if (currentMap[static_cast<size_t>(j)] == -1) continue;
             int distVal = std::abs(currentMap[static_cast<size_t>(i)] -
                                    currentMap[static_cast<size_t>(j)]);
-            if (distanceCounter.find(distVal) == distanceCounter.end()) {
+            if (!distanceCounter.contains(distVal)) {
                 conflicts.emplace_back(j, i);
             }
         }
@@ -247,8 +260,8 @@ void DebugMapSolver::dumpStateToFile(const std::string& filename) const {
         stateFile << i << ": " << currentMap[static_cast<size_t>(i)] << "\n";
     }
     stateFile << "\nDistance usage:\n";
-    for (const auto& [distance, cnt] : distanceCounter) {
-        stateFile << distance << ": " << cnt << "\n";
+    for (int slot = 0; slot < distanceCounter.distinctCount(); ++slot) {
+        stateFile << distanceCounter.valueAt(slot) << ": " << distanceCounter.countAt(slot) << "\n";
     }
     stateFile << "\nInvalidation history:\n";
     for (const auto& [pos, mp] : invalidationHistory) {
@@ -0,0 +1,120 @@
+#include "../include/delta_kernel.h"
+#include <atomic>
+#include <cstdlib>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DELTA_KERNEL_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    // -1 until the first removal picks a path, then whether AVX2 is used.
+    std::atomic<int> avx2Active{-1};
+
+    bool select(DeltaKernel::Mode mode) {
+        return mode != DeltaKernel::Mode::SCALAR && DeltaKernel::avx2Supported();
+    }
+
+#ifdef DELTA_KERNEL_HAS_AVX2
+    // Writes the slots of 8 deltas; false if any is out of range or absent.
+    __attribute__((target("avx2")))
+    inline bool slotsOf8(__m256i vy, __m256i vTableSize, const int* slotTable,
+                         const int* points, int* slots) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(points));
+        __m256i d = _mm256_abs_epi32(_mm256_sub_epi32(vy, x));
+        __m256i inRange = _mm256_cmpgt_epi32(vTableSize, d);
+        if (_mm256_movemask_epi8(inRange) != -1) {
+            return false;
+        }
+        __m256i s = _mm256_i32gather_epi32(slotTable, d, 4);
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(s)) != 0) {
+            return false;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(slots), s);
+        return true;
+    }
+
+    __attribute__((target("avx2")))
+    bool removeDeltasAvx2Impl(DistanceMultiset& D, int y, const int* points, size_t count) {
+        const int* slotTable = D.slotData();
+        __m256i vy = _mm256_set1_epi32(y);
+        __m256i vTableSize = _mm256_set1_epi32(D.slotTableSize());
+        int slots[8];
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            if (!slotsOf8(vy, vTableSize, slotTable, points + i, slots) || !D.removeSlots(slots, 8)) {
+                D.restoreDeltas(y, points, i);
+                return false;
+            }
+        }
+        if (!D.removeDeltas(y, points + i, count - i)) {
+            D.restoreDeltas(y, points, i);
+            return false;
+        }
+        return true;
+    }
+
+    __attribute__((target("avx2")))
+    void restoreDeltasAvx2Impl(DistanceMultiset& D, int y, const int* points, size_t count) {
+        const int* slotTable = D.slotData();
+        __m256i vy = _mm256_set1_epi32(y);
+        int slots[8];
+
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            // Only deltas of a successful removal come back, so they are all in range.
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(points + i));
+            __m256i d = _mm256_abs_epi32(_mm256_sub_epi32(vy, x));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(slots), _mm256_i32gather_epi32(slotTable, d, 4));
+            D.restoreSlots(slots, 8);
+        }
+        D.restoreDeltas(y, points + i, count - i);
+    }
+#endif
+}
+
+bool DeltaKernel::avx2Supported() {
+#ifdef DELTA_KERNEL_HAS_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void DeltaKernel::setMode(Mode mode) {
+    avx2Active.store(select(mode) ? 1 : 0, std::memory_order_relaxed);
+}
+
+DeltaKernel::Mode DeltaKernel::activeMode() {
+    return enabled() ? Mode::AVX2 : Mode::SCALAR;
+}
+
+bool DeltaKernel::enabled() {
+    int active = avx2Active.load(std::memory_order_relaxed);
+    if (active < 0) {
+        active = select(Mode::AUTO) ? 1 : 0;
+        avx2Active.store(active, std::memory_order_relaxed);
+    }
+    return active == 1;
+}
+
+bool DeltaKernel::removeDeltasAvx2(DistanceMultiset& D, int y, const int* points, size_t count) {
+#ifdef DELTA_KERNEL_HAS_AVX2
+    if (avx2Supported()) {
+        return removeDeltasAvx2Impl(D, y, points, count);
+    }
+#endif
+    return D.removeDeltas(y, points, count);
+}
+
+void DeltaKernel::restoreDeltasAvx2(DistanceMultiset& D, int y, const int* points, size_t count) {
+#ifdef DELTA_KERNEL_HAS_AVX2
+    if (avx2Supported()) {
+        restoreDeltasAvx2Impl(D, y, points, count);
+        return;
+    }
+#endif
+    D.restoreDeltas(y, points, count);
+}
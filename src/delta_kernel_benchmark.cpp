@@ -0,0 +1,104 @@
+#include "../include/delta_kernel_benchmark.h"
+#include "../include/restriction_map.h"
+#include "../include/algorithms/bbd_algorithm.h"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+DeltaKernelBenchmark::DeltaKernelBenchmark(std::vector<int> sizes, int placementsPerSize)
+    : instanceSizes(std::move(sizes)), placementCount(placementsPerSize) {}
+
+std::vector<DeltaKernelBenchmark::KernelResult> DeltaKernelBenchmark::run() {
+    std::vector<KernelResult> results;
+    for (int sizeVal : instanceSizes) {
+        RestrictionMap map;
+        if (sizeVal < 3 || !map.generateMap(sizeVal - 2)) {
+            continue;
+        }
+        const auto& sites = map.getSites();
+        std::vector<int> distances = map.generateDistances();
+        DistanceMultiset D(distances);
+
+        std::vector<std::vector<int>> pointSets;
+        std::vector<int> probes;
+        pointSets.reserve(sites.size());
+        probes.reserve(sites.size());
+        for (size_t i = 0; i < sites.size(); ++i) {
+            std::vector<int> others;
+            others.reserve(sites.size() - 1);
+            for (size_t j = 0; j < sites.size(); ++j) {
+                if (j != i) {
+                    others.push_back(sites[j]);
+                }
+            }
+            pointSets.push_back(std::move(others));
+            probes.push_back(sites[i]);
+        }
+
+        KernelResult result{sizeVal, 0.0, 0.0, 0.0, 0.0};
+        result.scalarNsPerPlacement = measurePlacements(DeltaKernel::Mode::SCALAR, D, pointSets, probes);
+        result.avx2NsPerPlacement = measurePlacements(DeltaKernel::Mode::AVX2, D, pointSets, probes);
+        result.scalarSolveMs = measureSolve(DeltaKernel::Mode::SCALAR, distances);
+        result.avx2SolveMs = measureSolve(DeltaKernel::Mode::AVX2, distances);
+        results.push_back(result);
+    }
+    DeltaKernel::setMode(DeltaKernel::Mode::AUTO);
+    return results;
+}
+
+double DeltaKernelBenchmark::measurePlacements(DeltaKernel::Mode mode,
+                                               DistanceMultiset D,
+                                               const std::vector<std::vector<int>>& pointSets,
+                                               const std::vector<int>& probes) const
+{
+    DeltaKernel::setMode(mode);
+    size_t placed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < placementCount; ++i) {
+        size_t p = static_cast<size_t>(i) % probes.size();
+        const auto& points = pointSets[p];
+        if (D.removeDeltas(probes[p], points)) {
+            D.restoreDeltas(probes[p], points);
+            ++placed;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (placed != static_cast<size_t>(placementCount)) {
+        std::cerr << "Delta removal failed on a valid map.\n";
+    }
+    double totalNs = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+    );
+    return totalNs / static_cast<double>(placementCount);
+}
+
+double DeltaKernelBenchmark::measureSolve(DeltaKernel::Mode mode, const std::vector<int>& distances) {
+    DeltaKernel::setMode(mode);
+    BBdAlgorithm solver;
+    auto start = std::chrono::steady_clock::now();
+    if (!solver.solve(distances)) {
+        std::cerr << "BBd found no map for a valid instance.\n";
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void DeltaKernelBenchmark::printResults(const std::vector<KernelResult>& results) const {
+    std::cout << "\nDelta removal benchmark (AVX2 "
+              << (DeltaKernel::avx2Supported() ? "available" : "not available, scalar used") << ")\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(8) << "n"
+              << std::setw(16) << "scalar ns"
+              << std::setw(16) << "avx2 ns"
+              << std::setw(16) << "BBd scalar ms"
+              << std::setw(16) << "BBd avx2 ms" << "\n";
+    std::cout << std::string(72, '-') << "\n";
+    for (const auto& result : results) {
+        std::cout << std::setw(8) << result.instanceSize
+                  << std::setw(16) << result.scalarNsPerPlacement
+                  << std::setw(16) << result.avx2NsPerPlacement
+                  << std::setw(16) << result.scalarSolveMs
+                  << std::setw(16) << result.avx2SolveMs << "\n";
+    }
+    std::cout << std::defaultfloat;
+}
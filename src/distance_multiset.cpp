@@ -0,0 +1,122 @@
+#include "../include/distance_multiset.h"
+#include "../include/delta_kernel.h"
+#include <algorithm>
+#include <cstdlib>
+
+DistanceMultiset::DistanceMultiset(const std::vector<int>& distances) {
+    auto idx = std::make_shared<Index>();
+    idx->values = distances;
+    std::sort(idx->values.begin(), idx->values.end());
+    idx->values.erase(std::unique(idx->values.begin(), idx->values.end()), idx->values.end());
+    idx->values.erase(idx->values.begin(),
+                      std::lower_bound(idx->values.begin(), idx->values.end(), 0));
+
+    int maxValue = idx->values.empty() ? -1 : idx->values.back();
+    idx->slotOf.assign(static_cast<size_t>(maxValue) + 1, -1);
+    for (size_t i = 0; i < idx->values.size(); ++i) {
+        idx->slotOf[static_cast<size_t>(idx->values[i])] = static_cast<int>(i);
+    }
+
+    counts.assign(idx->values.size(), 0);
+    for (int d : distances) {
+        if (d >= 0) {
+            counts[static_cast<size_t>(idx->slotOf[static_cast<size_t>(d)])]++;
+            remaining++;
+        }
+    }
+    topSlot = static_cast<int>(counts.size()) - 1;
+
+    slotTable = idx->slotOf.data();
+    tableSize = static_cast<int>(idx->slotOf.size());
+    index = std::move(idx);
+}
+
+DistanceMultiset DistanceMultiset::fromVector(const std::vector<int>& distances) {
+    return DistanceMultiset(distances);
+}
+
+bool DistanceMultiset::contains(int value, int cnt) const {
+    int slot = slotOf(value);
+    return slot >= 0 && counts[static_cast<size_t>(slot)] >= cnt;
+}
+
+int DistanceMultiset::count(int value) const {
+    int slot = slotOf(value);
+    return slot >= 0 ? counts[static_cast<size_t>(slot)] : 0;
+}
+
+bool DistanceMultiset::removeSlots(const int* slots, size_t count) {
+    // Decrement without branching and check once: a count that went below
+    // zero leaves the sign bit set in low.
+    int low = 0;
+    for (size_t i = 0; i < count; ++i) {
+        low |= --counts[static_cast<size_t>(slots[i])];
+    }
+    remaining -= static_cast<int>(count);
+    if (low >= 0) {
+        return true;
+    }
+    restoreSlots(slots, count);
+    return false;
+}
+
+void DistanceMultiset::restoreSlots(const int* slots, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        restoreSlot(slots[i]);
+    }
+}
+
+bool DistanceMultiset::removeDeltas(int y, const int* points, size_t count) {
+    if (count >= DeltaKernel::MIN_BATCH && DeltaKernel::enabled()) {
+        return DeltaKernel::removeDeltasAvx2(*this, y, points, count);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!remove(std::abs(y - points[i]))) {
+            restoreDeltas(y, points, i);
+            return false;
+        }
+    }
+    return true;
+}
+
+void DistanceMultiset::restoreDeltas(int y, const int* points, size_t count) {
+    if (count >= DeltaKernel::MIN_BATCH && DeltaKernel::enabled()) {
+        DeltaKernel::restoreDeltasAvx2(*this, y, points, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        restore(std::abs(y - points[i]));
+    }
+}
+
+int DistanceMultiset::max() const {
+    while (topSlot >= 0 && counts[static_cast<size_t>(topSlot)] == 0) {
+        --topSlot;
+    }
+    return topSlot >= 0 ? index->values[static_cast<size_t>(topSlot)] : -1;
+}
+
+size_t DistanceMultiset::indexMemoryBytes() const {
+    if (!index) {
+        return 0;
+    }
+    return (index->values.capacity() + index->slotOf.capacity()) * sizeof(int);
+}
+
+std::vector<int> DistanceMultiset::toVector() const {
+    std::vector<int> result;
+    result.reserve(static_cast<size_t>(remaining));
+    for (size_t slot = 0; slot < counts.size(); ++slot) {
+        for (int i = 0; i < counts[slot]; ++i) {
+            result.push_back(index->values[slot]);
+        }
+    }
+    return result;
+}
+
+bool DistanceMultiset::operator==(const DistanceMultiset& other) const {
+    if (index == other.index) {
+        return remaining == other.remaining && counts == other.counts;
+    }
+    return toVector() == other.toVector();
+}
@@ -3,6 +3,7 @@
 #include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <bit>
 
 MapSolver::MapSolver(const std::vector<int>& inputDistances, int length)
     : distances(inputDistances), totalLength(length), processedPaths(0)
@@ -12,12 +13,9 @@ MapSolver::MapSolver(const std::vector<int>& inputDistances, int length)
     maxind = static_cast<int>(sizeForMaxInd / 2);
 
     currentMap.resize(static_cast<size_t>(maxind), -1);
+    buildCandidatePositions();
     totalPaths = calculateTotalPaths();
 
-    for (int d : distances) {
-        distanceCounter[d]++;
-    }
-
     stats.totalPaths      = totalPaths;
     stats.processedPaths  = 0;
     stats.searchTimeMs    = 0.0;
@@ -26,11 +24,30 @@ MapSolver::MapSolver(const std::vector<int>& inputDistances, int length)
     stats.inputDistances  = distances;
 }
 
+void MapSolver::buildCandidatePositions() {
+    // A site p is at distance p from the site at 0, and once totalLength is a
+    // site (it must be when it is the largest distance), also at distance
+    // totalLength - p from it. Both have to be in D.
+    DistanceMultiset all(distances);
+    bool widthIsSite = all.contains(totalLength);
+    candidatePositions.clear();
+    for (int slot = 0; slot < all.distinctCount(); ++slot) {
+        int p = all.valueAt(slot);
+        if (p <= 0 || p > totalLength) {
+            continue;
+        }
+        if (widthIsSite && p < totalLength && !all.contains(totalLength - p, (2 * p == totalLength) ? 2 : 1)) {
+            continue;
+        }
+        candidatePositions.push_back(p);
+    }
+}
+
 uint64_t MapSolver::calculateTotalPaths() const {
-    // Very rough upper-bound calculation
+    // Rough upper bound: every free site may take any candidate position.
     uint64_t total = 1;
+    uint64_t range = std::max<uint64_t>(1, candidatePositions.size());
     for (int i = 1; i < maxind - 1; i++) {
-        uint64_t range = static_cast<uint64_t>(totalLength > i ? (totalLength - i) : 1);
         total *= range;
         if (total == 0) {
             break;
@@ -39,67 +56,78 @@ uint64_t MapSolver::calculateTotalPaths() const {
     return total;
 }
 
-bool MapSolver::isValidPartialSolution(int assignedCount) const {
-    if (assignedCount <= 1) return true;
-    std::map<int, int> usedDistances;
-    for (int i = 0; i < assignedCount; ++i) {
-        if (currentMap[static_cast<size_t>(i)] < 0) {
-            continue;
-        }
-        for (int j = 0; j < i; ++j) {
-            if (currentMap[static_cast<size_t>(j)] < 0) {
-                continue;
-            }
-            int distVal = std::abs(currentMap[static_cast<size_t>(i)] -
-                                   currentMap[static_cast<size_t>(j)]);
-            auto it = distanceCounter.find(distVal);
-            if (it == distanceCounter.end()) {
-                return false;
-            }
-            usedDistances[distVal]++;
-            if (usedDistances[distVal] > it->second) {
-                return false;
+bool MapSolver::placeSite(int ind, int pos) {
+    for (int j = 0; j < ind; ++j) {
+        int distVal = std::abs(pos - currentMap[static_cast<size_t>(j)]);
+        if (!remainingDistances.remove(distVal)) {
+            for (int k = 0; k < j; ++k) {
+                restoreDistance(std::abs(pos - currentMap[static_cast<size_t>(k)]));
             }
+            return false;
+        }
+        if (!presentBits.empty() && distVal <= totalLength && remainingDistances.count(distVal) == 0) {
+            clearBit(presentBits, distVal);
+            clearBit(mirroredBits, totalLength - distVal);
         }
     }
+    currentMap[static_cast<size_t>(ind)] = pos;
     return true;
 }
 
-void MapSolver::searchSolver(int ind, bool& foundSolution) {
-    if (foundSolution) {
-        return;
+void MapSolver::unplaceSite(int ind) {
+    int pos = currentMap[static_cast<size_t>(ind)];
+    for (int j = 0; j < ind; ++j) {
+        restoreDistance(std::abs(pos - currentMap[static_cast<size_t>(j)]));
     }
-    ++processedPaths;
-    if (ind == maxind) {
-        if (isValidPartialSolution(maxind)) {
-            foundSolution = true;
-            stats.solution = currentMap;
-            stats.solutionFound = true;
-        }
-        updateProgress();
-        return;
+    currentMap[static_cast<size_t>(ind)] = -1;
+}
+
+void MapSolver::restoreDistance(int distVal) {
+    remainingDistances.restore(distVal);
+    if (!presentBits.empty() && distVal <= totalLength) {
+        setBit(presentBits, distVal);
+        setBit(mirroredBits, totalLength - distVal);
     }
+}
 
+std::pair<int, int> MapSolver::siteRange(int ind) const {
     int startVal = (ind == 0) ? 0 : 1;
     int endVal = (ind == maxind - 1) ? totalLength : (totalLength - (maxind - ind - 1));
+    return {startVal, std::max(startVal, endVal)};
+}
 
-    if (startVal < 0) {
-        startVal = 0;
+void MapSolver::searchSolver(int ind, bool& foundSolution) {
+    if (foundSolution || (guard && !guard->expand())) {
+        return;
     }
-    if (endVal < startVal) {
-        endVal = startVal;
+    ++processedPaths;
+    if (ind == maxind) {
+        // Every pair was checked against the distances as its sites were placed.
+        foundSolution = true;
+        stats.solution = currentMap;
+        stats.solutionFound = true;
+        updateProgress();
+        return;
     }
 
-    for (int pos = startVal; pos <= endVal && !foundSolution; ++pos) {
-        currentMap[static_cast<size_t>(ind)] = pos;
-        if (isValidPartialSolution(ind + 1)) {
+    auto [startVal, endVal] = siteRange(ind);
+    auto first = std::lower_bound(candidatePositions.begin(), candidatePositions.end(), startVal);
+    auto last = std::upper_bound(first, candidatePositions.end(), endVal);
+    for (auto it = first; it != last && !foundSolution && !outOfBudget(); ++it) {
+        if (placeSite(ind, *it)) {
             searchSolver(ind + 1, foundSolution);
+            unplaceSite(ind);
         }
     }
-    currentMap[static_cast<size_t>(ind)] = -1;
 }
 
 std::optional<std::vector<int>> MapSolver::solve() {
+    return solve(SearchBudget{}).solution;
+}
+
+SolveResult MapSolver::solve(const SearchBudget& budget) {
+    BudgetGuard budgetGuard(budget);
+    guard = &budgetGuard;
     bool foundSolution = false;
     startTime = std::chrono::steady_clock::now();
     std::fill(currentMap.begin(), currentMap.end(), -1);
@@ -107,39 +135,48 @@ std::optional<std::vector<int>> MapSolver::solve() {
         currentMap.front() = 0;
         currentMap.back() = totalLength;
     }
+    initializeRemainingDistances();
+
+    if (budgetGuard.trackMemory(memoryBytes())) {
+        searchSolver(1, foundSolution);
+    }
+    finishSearch();
+
+    if (foundSolution) {
+        return budgetGuard.finish(stats.solution);
+    }
+    return budgetGuard.finish(std::nullopt);
+}
 
-    searchSolver(1, foundSolution);
+size_t MapSolver::memoryBytes() const {
+    size_t bytes = (distances.capacity() + currentMap.capacity() + candidatePositions.capacity()) * sizeof(int)
+                 + remainingDistances.memoryBytes() + remainingDistances.indexMemoryBytes()
+                 + (presentBits.capacity() + mirroredBits.capacity() + candidateBits.capacity()) * sizeof(uint64_t);
+    for (const auto& mask : depthMasks) {
+        bytes += mask.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
 
+void MapSolver::finishSearch() {
     auto endTime = std::chrono::steady_clock::now();
     stats.searchTimeMs = static_cast<double>(
         std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count()
     );
     stats.processedPaths = processedPaths;
-
-    if (foundSolution) {
-        return stats.solution;
-    }
-    return std::nullopt;
+    guard = nullptr;
 }
 
 void MapSolver::initializeRemainingDistances() {
-    remainingDistances.clear();
-    for (int d : distances) {
-        remainingDistances[d]++;
-    }
+    remainingDistances = DistanceMultiset(distances);
 }
 
 bool MapSolver::updateDistanceUsage(int distance, bool add) {
     if (add) {
-        remainingDistances[distance]++;
+        remainingDistances.restore(distance);
         return true;
     }
-    auto it = remainingDistances.find(distance);
-    if (it == remainingDistances.end() || it->second == 0) {
-        return false;
-    }
-    it->second--;
-    return true;
+    return remainingDistances.remove(distance);
 }
 
 void MapSolver::updateProgress() {
@@ -154,7 +191,145 @@ void MapSolver::displayProgress() const {
     std::cout << "\rPaths processed: " << processedPaths << " | Time: " << elapsedMs << "ms" << std::flush;
 }
 
+std::optional<std::vector<int>> MapSolver::solveBitset() {
+    return solveBitset(SearchBudget{}).solution;
+}
+
+SolveResult MapSolver::solveBitset(const SearchBudget& budget) {
+    BudgetGuard budgetGuard(budget);
+    guard = &budgetGuard;
+    bool foundSolution = false;
+    startTime = std::chrono::steady_clock::now();
+    std::fill(currentMap.begin(), currentMap.end(), -1);
+    if (!currentMap.empty()) {
+        currentMap.front() = 0;
+        currentMap.back() = totalLength;
+    }
+    initializeRemainingDistances();
+    initializeBitsets();
+
+    if (budgetGuard.trackMemory(memoryBytes())) {
+        searchSolverBitset(1, foundSolution);
+    }
+    finishSearch();
+    presentBits.clear();
+    mirroredBits.clear();
+
+    if (foundSolution) {
+        return budgetGuard.finish(stats.solution);
+    }
+    return budgetGuard.finish(std::nullopt);
+}
+
+void MapSolver::initializeBitsets() {
+    size_t words = static_cast<size_t>(totalLength) / 64 + 1;
+    presentBits.assign(words, 0);
+    mirroredBits.assign(words, 0);
+    for (int slot = 0; slot < remainingDistances.distinctCount(); ++slot) {
+        int distVal = remainingDistances.valueAt(slot);
+        if (distVal >= 0 && distVal <= totalLength) {
+            setBit(presentBits, distVal);
+            setBit(mirroredBits, totalLength - distVal);
+        }
+    }
+    candidateBits.assign(words, 0);
+    for (int pos : candidatePositions) {
+        setBit(candidateBits, pos);
+    }
+    depthMasks.assign(static_cast<size_t>(std::max(maxind, 1)), std::vector<uint64_t>(words));
+}
+
+void MapSolver::searchSolverBitset(int ind, bool& foundSolution) {
+    if (foundSolution || (guard && !guard->expand())) {
+        return;
+    }
+    ++processedPaths;
+    if (ind == maxind) {
+        foundSolution = true;
+        stats.solution = currentMap;
+        stats.solutionFound = true;
+        updateProgress();
+        return;
+    }
+
+    // pos survives site x when |pos - x| is still in D: pos = x + d is bit d
+    // of presentBits shifted up by x, and pos = x - d is bit (L - d) of
+    // mirroredBits shifted down by L - x.
+    auto [startVal, endVal] = siteRange(ind);
+    std::vector<uint64_t>& mask = depthMasks[static_cast<size_t>(ind)];
+    size_t words = mask.size();
+    for (size_t w = 0; w < words; ++w) {
+        mask[w] = candidateBits[w] & rangeWord(w, startVal, endVal);
+    }
+    for (int j = 0; j < ind; ++j) {
+        int x = currentMap[static_cast<size_t>(j)];
+        for (size_t w = 0; w < words; ++w) {
+            mask[w] &= shiftedUp(presentBits, w, x) | shiftedDown(mirroredBits, w, totalLength - x);
+        }
+    }
+
+    for (size_t w = 0; w < words && !foundSolution && !outOfBudget(); ++w) {
+        uint64_t bits = mask[w];
+        while (bits != 0 && !foundSolution && !outOfBudget()) {
+            int pos = static_cast<int>(w * 64) + std::countr_zero(bits);
+            bits &= bits - 1;
+            // The mask only knows which distances are left, not how many.
+            if (placeSite(ind, pos)) {
+                searchSolverBitset(ind + 1, foundSolution);
+                unplaceSite(ind);
+            }
+        }
+    }
+}
+
+uint64_t MapSolver::shiftedUp(const std::vector<uint64_t>& bits, size_t word, int shift) {
+    size_t wordShift = static_cast<size_t>(shift) / 64;
+    int bitShift = shift % 64;
+    if (word < wordShift) {
+        return 0;
+    }
+    size_t src = word - wordShift;
+    uint64_t value = bits[src] << bitShift;
+    if (bitShift != 0 && src > 0) {
+        value |= bits[src - 1] >> (64 - bitShift);
+    }
+    return value;
+}
+
+uint64_t MapSolver::shiftedDown(const std::vector<uint64_t>& bits, size_t word, int shift) {
+    size_t src = word + static_cast<size_t>(shift) / 64;
+    int bitShift = shift % 64;
+    if (src >= bits.size()) {
+        return 0;
+    }
+    uint64_t value = bits[src] >> bitShift;
+    if (bitShift != 0 && src + 1 < bits.size()) {
+        value |= bits[src + 1] << (64 - bitShift);
+    }
+    return value;
+}
+
+uint64_t MapSolver::rangeWord(size_t word, int low, int high) {
+    int base = static_cast<int>(word * 64);
+    if (high < base || low > base + 63) {
+        return 0;
+    }
+    uint64_t value = ~0ULL;
+    if (low > base) {
+        value &= ~0ULL << (low - base);
+    }
+    if (high < base + 63) {
+        value &= ~0ULL >> (63 - (high - base));
+    }
+    return value;
+}
+
 std::optional<std::vector<int>> MapSolver::solveWithCondition() {
+    return solveWithCondition(SearchBudget{}).solution;
+}
+
+SolveResult MapSolver::solveWithCondition(const SearchBudget& budget) {
+    BudgetGuard budgetGuard(budget);
     bool foundSolution = false;
     startTime = std::chrono::steady_clock::now();
     std::fill(currentMap.begin(), currentMap.end(), -1);
@@ -164,36 +339,28 @@ std::optional<std::vector<int>> MapSolver::solveWithCondition() {
     }
     initializeRemainingDistances();
     if (!updateDistanceUsage(totalLength, false)) {
-        return std::nullopt;
+        return budgetGuard.finish(std::nullopt);
     }
-    searchSolverWithCondition(1, foundSolution);
-    auto endTime = std::chrono::steady_clock::now();
-    stats.searchTimeMs = static_cast<double>(
-        std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count()
-    );
-    stats.processedPaths = processedPaths;
+    guard = &budgetGuard;
+    if (budgetGuard.trackMemory(memoryBytes())) {
+        searchSolverWithCondition(1, foundSolution);
+    }
+    finishSearch();
 
     if (foundSolution) {
-        return stats.solution;
+        return budgetGuard.finish(stats.solution);
     }
-    return std::nullopt;
+    return budgetGuard.finish(std::nullopt);
 }
 
 void MapSolver::searchSolverWithCondition(int ind, bool& foundSolution) {
-    if (foundSolution) {
+    if (foundSolution || (guard && !guard->expand())) {
         return;
     }
     ++processedPaths;
     if (ind == maxind - 1) {
         updateProgress();
-        bool allUsed = true;
-        for (const auto& kv : remainingDistances) {
-            if (kv.second != 0) {
-                allUsed = false;
-                break;
-            }
-        }
-        if (allUsed) {
+        if (remainingDistances.empty()) {
             foundSolution = true;
             stats.solution = currentMap;
             stats.solutionFound = true;
@@ -204,7 +371,10 @@ void MapSolver::searchSolverWithCondition(int ind, bool& foundSolution) {
     int startVal = 1;
     int endVal = totalLength - (maxind - ind - 1);
 
-    for (int pos = startVal; pos <= endVal; ++pos) {
+    auto first = std::lower_bound(candidatePositions.begin(), candidatePositions.end(), startVal);
+    auto last = std::upper_bound(first, candidatePositions.end(), endVal);
+    for (auto it = first; it != last && !outOfBudget(); ++it) {
+        int pos = *it;
         bool canPlace = true;
         std::vector<int> usedValues;
         usedValues.reserve(static_cast<size_t>(ind));
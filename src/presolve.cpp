@@ -0,0 +1,101 @@
+#include "../include/presolve.h"
+#include "../include/distance_multiset.h"
+#include "../include/symmetry.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <numeric>
+
+namespace {
+    // Every distance from y to points is still in D, with multiplicity.
+    bool fits(DistanceMultiset& D, const std::vector<int>& points, int y) {
+        if (!D.removeDeltas(y, points)) {
+            return false;
+        }
+        D.restoreDeltas(y, points);
+        return true;
+    }
+
+    void place(DistanceMultiset& D, std::vector<int>& points, int y) {
+        D.removeDeltas(y, points);
+        points.insert(std::lower_bound(points.begin(), points.end(), y), y);
+    }
+
+    Presolve::Result reject(const char* reason) {
+        Presolve::Result result;
+        result.feasible = false;
+        result.reason = reason;
+        return result;
+    }
+}
+
+std::vector<int> Presolve::Result::restore(const std::vector<int>& reducedMap) const {
+    std::vector<int> map = reducedMap;
+    for (int& x : map) {
+        x *= scale;
+    }
+    return map;
+}
+
+Presolve::Result Presolve::reduce(const std::vector<int>& distances) {
+    if (distances.empty()) {
+        return reject("no distances");
+    }
+    // A map of n points has exactly n(n-1)/2 distances.
+    size_t m = distances.size();
+    auto n = static_cast<size_t>(std::llround((1.0 + std::sqrt(1.0 + 8.0 * static_cast<double>(m))) / 2.0));
+    if (n * (n - 1) / 2 != m) {
+        return reject("number of distances is not n(n-1)/2");
+    }
+    if (*std::min_element(distances.begin(), distances.end()) <= 0) {
+        return reject("distance is not positive");
+    }
+
+    // Every point of a map is a distance from 0, so all of them share the GCD.
+    Result result;
+    result.scale = std::accumulate(distances.begin(), distances.end(), 0,
+                                   [](int g, int d) { return std::gcd(g, d); });
+    result.distances.reserve(m);
+    for (int d : distances) {
+        result.distances.push_back(d / result.scale);
+    }
+
+    DistanceMultiset D(result.distances);
+    int width = D.max();
+    if (D.count(width) != 1) {
+        return reject("width occurs more than once");
+    }
+    // Each point is the left end of at most one pair at a given distance.
+    for (int slot = 0; slot < D.distinctCount(); ++slot) {
+        if (static_cast<size_t>(D.countAt(slot)) > n - 1) {
+            return reject("distance occurs more than n - 1 times");
+        }
+    }
+
+    // The largest remaining distance can only be realized from an end, so it
+    // goes at y or width - y. A choice exists only if both sides fit and the
+    // points are not their own mirror image.
+    std::vector<int> points{0, width};
+    D.remove(width);
+    while (!D.empty()) {
+        int y = D.max();
+        bool nearFits = fits(D, points, y);
+        bool farFits = width - y != y
+                    && !Symmetry::isSelfMirror(points.data(), points.size())
+                    && fits(D, points, width - y);
+        if (!nearFits && !farFits) {
+            return reject("largest remaining distance fits on neither side");
+        }
+        if (nearFits && farFits) {
+            break;
+        }
+        place(D, points, nearFits ? y : width - y);
+        ++result.forcedPoints;
+    }
+    if (D.empty()) {
+        result.solution = result.restore(points);
+    }
+    result.placed = std::move(points);
+    result.remaining = std::move(D);
+    return result;
+}
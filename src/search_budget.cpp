@@ -0,0 +1,86 @@
+#include "../include/search_budget.h"
+#include <algorithm>
+#include <limits>
+
+const char* solveStatusName(SolveStatus status) {
+    switch (status) {
+        case SolveStatus::SOLVED:          return "solved";
+        case SolveStatus::NO_SOLUTION:     return "no solution";
+        case SolveStatus::BUDGET_EXCEEDED: return "budget exceeded";
+        case SolveStatus::CANCELLED:       return "cancelled";
+        default:                           return "unknown";
+    }
+}
+
+BudgetGuard::BudgetGuard(const SearchBudget& budget)
+    : start(std::chrono::steady_clock::now()),
+      deadline(budget.deadline),
+      maxNodes(budget.maxNodes),
+      maxMemory(budget.maxMemoryBytes),
+      cancellation(budget.cancellation)
+{
+    if (budget.timeLimit.count() > 0) {
+        auto limit = start + budget.timeLimit;
+        deadline = deadline ? std::min(*deadline, limit) : limit;
+    }
+}
+
+bool BudgetGuard::poll() {
+    if (exhausted()) {
+        return false;
+    }
+    if (cancellation && cancellation->isCancelled()) {
+        fail(SolveStatus::CANCELLED);
+        return false;
+    }
+    if (deadline && std::chrono::steady_clock::now() >= *deadline) {
+        fail(SolveStatus::BUDGET_EXCEEDED);
+        return false;
+    }
+    return true;
+}
+
+bool BudgetGuard::trackMemory(size_t bytesInUse) {
+    size_t peak = peakMemory.load(std::memory_order_relaxed);
+    while (bytesInUse > peak &&
+           !peakMemory.compare_exchange_weak(peak, bytesInUse, std::memory_order_relaxed)) {
+    }
+    if (maxMemory > 0 && bytesInUse > maxMemory) {
+        fail(SolveStatus::BUDGET_EXCEEDED);
+        return false;
+    }
+    return !exhausted();
+}
+
+uint64_t BudgetGuard::nodesLeft() const {
+    if (maxNodes == 0) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    uint64_t used = nodes.load(std::memory_order_relaxed);
+    return used >= maxNodes ? 0 : maxNodes - used;
+}
+
+void BudgetGuard::fail(SolveStatus status) {
+    int expected = 0;
+    failure.compare_exchange_strong(expected, static_cast<int>(status) + 1, std::memory_order_relaxed);
+}
+
+SolveResult BudgetGuard::finish(std::optional<std::vector<int>> solution) const {
+    SolveResult result;
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    // Parallel workers can charge a few nodes past maxNodes before they see
+    // the failure; the count shows how far they went.
+    result.stats.nodesExpanded = nodes.load(std::memory_order_relaxed);
+    result.stats.elapsedMs = std::chrono::duration<double, std::milli>(elapsed).count();
+    result.stats.peakMemoryBytes = peakMemory.load(std::memory_order_relaxed);
+
+    if (solution) {
+        result.status = SolveStatus::SOLVED;
+        result.solution = std::move(solution);
+    } else if (exhausted()) {
+        result.status = static_cast<SolveStatus>(failure.load(std::memory_order_relaxed) - 1);
+    } else {
+        result.status = SolveStatus::NO_SOLUTION;
+    }
+    return result;
+}
@@ -7,11 +7,39 @@
 #include <cmath>
 #include <set>
 #include <chrono>
+#include <thread>
 
 namespace fs = std::filesystem;
 
 const std::chrono::hours TestFramework::MAX_EXECUTION_TIME(1);
 
+SearchBudget TestFramework::executionBudget() {
+    SearchBudget budget;
+    budget.timeLimit = MAX_EXECUTION_TIME;
+    return budget;
+}
+
+SolveResult TestFramework::solvePresolved(const std::vector<int>& distances,
+                                          const std::function<SolveResult(const Presolve::Result&)>& solve) {
+    Presolve::Result reduced = Presolve::reduce(distances);
+    if (!reduced.feasible) {
+        return SolveResult{};
+    }
+    if (reduced.solution) {
+        return SolveResult{SolveStatus::SOLVED, reduced.solution, {}};
+    }
+    SolveResult result = solve(reduced);
+    if (result.solution) {
+        result.solution = reduced.restore(*result.solution);
+    }
+    return result;
+}
+
+SolveResult TestFramework::solveWithBBb(const Presolve::Result& reduced) {
+    BudgetGuard guard(executionBudget());
+    return guard.finish(bbbSolver.solvePartial(reduced.placed, reduced.remaining, guard));
+}
+
 TestFramework::TestFramework(InstanceGenerator& gen)
     : generator(gen) 
 {
@@ -144,12 +172,18 @@ TestFramework::VerificationResult TestFramework::verifyInstanceFile(const std::s
     }
 
     auto start = std::chrono::high_resolution_clock::now();
-    auto solution = bbbSolver.solve(distances);
+    SolveResult result = solvePresolved(distances, [this](const Presolve::Result& reduced) {
+        return solveWithBBb(reduced);
+    });
     auto end = std::chrono::high_resolution_clock::now();
     double timeMs = static_cast<double>(
         std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
     );
 
+    const auto& solution = result.solution;
+    if (result.status == SolveStatus::BUDGET_EXCEEDED) {
+        return {false, "BBb algorithm exceeded the execution time limit", std::nullopt, timeMs};
+    }
     if (!solution) {
         return {false, "No solution found using BBb algorithm", std::nullopt, timeMs};
     }
@@ -253,7 +287,10 @@ bool TestFramework::solveSpecificInstance(const std::string& input) {
     std::cout << "3. BBd Algorithm\n";
     std::cout << "4. Basic Map Solver\n";
     std::cout << "5. Debug Basic Map Solver\n";
-    std::cout << "Enter choice (1-5): ";
+    std::cout << "6. Parallel BBd Algorithm\n";
+    std::cout << "7. Enumerate all maps (BBd)\n";
+    std::cout << "8. Bitset Map Solver\n";
+    std::cout << "Enter choice (1-8): ";
     int algorithmChoice = 0;
     std::cin >> algorithmChoice;
 
@@ -263,41 +300,96 @@ bool TestFramework::solveSpecificInstance(const std::string& input) {
         return false;
     }
 
-    std::optional<std::vector<int>> solution;
+    if (algorithmChoice < 1 || algorithmChoice > 8) {
+        std::cout << "Invalid algorithm choice\n";
+        return false;
+    }
+
+    SolveResult result;
     auto start = std::chrono::high_resolution_clock::now();
-    int totalLength = *std::max_element(distances.begin(), distances.end());
+    Presolve::Result reduced = Presolve::reduce(distances);
+    if (!reduced.feasible) {
+        std::cout << "Rejected by presolve: " << reduced.reason << "\n";
+        return false;
+    }
+    if (reduced.scale > 1 || reduced.forcedPoints > 0) {
+        std::cout << "Presolve: distances divided by " << reduced.scale << ", "
+                  << reduced.forcedPoints << " forced placements\n";
+    }
+    const std::vector<int>& reducedDistances = reduced.distances;
+    int totalLength = *std::max_element(reducedDistances.begin(), reducedDistances.end());
     std::string logFilename = "debug_" + filename + ".log";
 
-    switch (algorithmChoice) {
-        case 1:
-            solution = bbbSolver.solve(distances);
-            break;
-        case 2: {
-            BBb2Algorithm bbb2Solver;
-            solution = bbb2Solver.solve(distances);
-            break;
-        }
-        case 3: {
-            BBdAlgorithm bbdSolver;
-            solution = bbdSolver.solve(distances);
-            break;
-        }
-        case 4: {
-            MapSolver solver(distances, totalLength);
-            solution = solver.solve();
-            break;
+    if (reduced.solution) {
+        result.status = SolveStatus::SOLVED;
+        result.solution = reduced.solution;
+    } else {
+        switch (algorithmChoice) {
+            case 1:
+                result = solveWithBBb(reduced);
+                break;
+            case 2: {
+                BBb2Algorithm bbb2Solver;
+                result = bbb2Solver.solvePartial(reduced.placed, reduced.remaining, executionBudget());
+                break;
+            }
+            case 3: {
+                BBdAlgorithm bbdSolver;
+                result = bbdSolver.solvePartial(reduced.placed, reduced.remaining, executionBudget());
+                break;
+            }
+            case 4: {
+                MapSolver solver(reducedDistances, totalLength);
+                result = solver.solve(executionBudget());
+                break;
+            }
+            case 5: {
+                DebugMapSolver debugSolver(reducedDistances, totalLength, true, logFilename);
+                result = debugSolver.solve(executionBudget());
+                const auto& stats = debugSolver.getStatistics();
+                displayDebugStatistics(stats);
+                std::cout << "Debug log saved to: " << logFilename << "\n";
+                break;
+            }
+            case 6: {
+                BBdAlgorithm bbdSolver;
+                bbdSolver.setThreadCount(static_cast<int>(std::thread::hardware_concurrency()));
+                result = bbdSolver.solvePartial(reduced.placed, reduced.remaining, executionBudget());
+                break;
+            }
+            case 7: {
+                BBdAlgorithm bbdSolver;
+                EnumerationOptions options;
+                options.timeLimit = MAX_EXECUTION_TIME;
+                auto& solution = result.solution;
+                auto summary = bbdSolver.enumeratePartial(reduced.placed, reduced.remaining,
+                                                          [&solution, &reduced](const std::vector<int>& map) {
+                    std::cout << "Map: ";
+                    for (int x : reduced.restore(map)) {
+                        std::cout << x << " ";
+                    }
+                    std::cout << "\n";
+                    if (!solution) {
+                        solution = map;
+                    }
+                    return true;
+                }, options);
+                std::cout << "Distinct maps (up to mirror image): " << summary.solutionCount << "\n";
+                if (!summary.complete) {
+                    result.status = SolveStatus::BUDGET_EXCEEDED;
+                    std::cout << "Enumeration stopped at the execution time limit\n";
+                }
+                break;
+            }
+            case 8: {
+                MapSolver solver(reducedDistances, totalLength);
+                result = solver.solveBitset(executionBudget());
+                break;
+            }
         }
-        case 5: {
-            DebugMapSolver debugSolver(distances, totalLength, true, logFilename);
-            solution = debugSolver.solve();
-            const auto& stats = debugSolver.getStatistics();
-            displayDebugStatistics(stats);
-            std::cout << "Debug log saved to: " << logFilename << "\n";
-            break;
+        if (result.solution) {
+            result.solution = reduced.restore(*result.solution);
         }
-        default:
-            std::cout << "Invalid algorithm choice\n";
-            return false;
     }
 
     auto end = std::chrono::high_resolution_clock::now();
@@ -305,6 +397,7 @@ bool TestFramework::solveSpecificInstance(const std::string& input) {
         std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
     );
 
+    const auto& solution = result.solution;
     std::cout << "\nResults for algorithm choice " << algorithmChoice << ":\n";
     if (solution) {
         std::cout << "Solution found in " << timeMs << "ms!\n";
@@ -318,6 +411,9 @@ bool TestFramework::solveSpecificInstance(const std::string& input) {
         } else {
             std::cout << "Solution validation: FAILED\n";
         }
+    } else if (result.status == SolveStatus::BUDGET_EXCEEDED) {
+        std::cout << "Search stopped: " << solveStatusName(result.status)
+                  << " (time: " << timeMs << "ms)\n";
     } else {
         std::cout << "No solution found (time: " << timeMs << "ms)\n";
     }
@@ -342,23 +438,27 @@ void TestFramework::testAllInstances(int algorithmChoice) {
                 std::cout << "Failed to load instance: " << fname << "\n";
                 continue;
             }
-            std::optional<std::vector<int>> solution;
+            SolveResult result;
             auto start = std::chrono::high_resolution_clock::now();
 
             switch (algorithmChoice) {
                 case 1:
-                    solution = bbbSolver.solve(distances);
+                    result = solvePresolved(distances, [this](const Presolve::Result& reduced) {
+                        return solveWithBBb(reduced);
+                    });
                     break;
-                case 2: {
-                    BBb2Algorithm bbb2Solver;
-                    solution = bbb2Solver.solve(distances);
+                case 2:
+                    result = solvePresolved(distances, [](const Presolve::Result& reduced) {
+                        BBb2Algorithm bbb2Solver;
+                        return bbb2Solver.solvePartial(reduced.placed, reduced.remaining, executionBudget());
+                    });
                     break;
-                }
-                case 3: {
-                    BBdAlgorithm bbdSolver;
-                    solution = bbdSolver.solve(distances);
+                case 3:
+                    result = solvePresolved(distances, [](const Presolve::Result& reduced) {
+                        BBdAlgorithm bbdSolver;
+                        return bbdSolver.solvePartial(reduced.placed, reduced.remaining, executionBudget());
+                    });
                     break;
-                }
                 default:
                     std::cout << "Invalid algorithm choice\n";
                     return;
@@ -368,9 +468,11 @@ void TestFramework::testAllInstances(int algorithmChoice) {
             double timeMs = static_cast<double>(
                 std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
             );
-            if (solution) {
+            if (result.solution) {
                 validFiles++;
                 std::cout << "Instance " << fname << ": SOLVED (" << timeMs << "ms)\n";
+            } else if (result.status == SolveStatus::BUDGET_EXCEEDED) {
+                std::cout << "Instance " << fname << ": TIME LIMIT EXCEEDED (" << timeMs << "ms)\n";
             } else {
                 std::cout << "Instance " << fname << ": NO SOLUTION FOUND (" << timeMs << "ms)\n";
             }
@@ -393,6 +495,7 @@ void TestFramework::runInteractiveMode() {
         std::cout << "5. Run benchmark\n";
         std::cout << "6. Run debug solver on instance\n";
         std::cout << "7. Run data arrangement analysis\n";
+        std::cout << "8. Run delta removal benchmark\n";
         std::cout << "0. Exit\n";
         std::cout << "Choose option: ";
 
@@ -446,6 +549,11 @@ void TestFramework::runInteractiveMode() {
                         runDataArrangementAnalysis(filename, reps);
                         break;
             }
+            case 8: {
+                DeltaKernelBenchmark kernelBenchmark;
+                kernelBenchmark.printResults(kernelBenchmark.run());
+                break;
+            }
             case 0:
                 return;
             default:
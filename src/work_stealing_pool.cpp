@@ -0,0 +1,100 @@
+#include "../include/work_stealing_pool.h"
+#include <algorithm>
+
+namespace {
+    thread_local const WorkStealingPool* workerPool = nullptr;
+    thread_local int workerIndex = -1;
+}
+
+WorkStealingPool::WorkStealingPool(int threadCount) {
+    int count = std::max(1, threadCount);
+    queues.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int WorkStealingPool::currentWorker() const {
+    return (workerPool == this) ? workerIndex : -1;
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    int target = currentWorker();
+    if (target < 0) {
+        target = static_cast<int>(nextQueue.fetch_add(1) % queues.size());
+    }
+    pendingTasks.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        queuedTasks.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[static_cast<size_t>(target)]->mutex);
+        queues[static_cast<size_t>(target)]->tasks.push_back(std::move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this] { return pendingTasks.load() == 0; });
+}
+
+bool WorkStealingPool::popTask(int index, std::function<void()>& task) {
+    {
+        WorkerQueue& own = *queues[static_cast<size_t>(index)];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(static_cast<size_t>(index) + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int index) {
+    workerPool = this;
+    workerIndex = index;
+    while (true) {
+        std::function<void()> task;
+        if (popTask(index, task)) {
+            queuedTasks.fetch_sub(1);
+            task();
+            if (pendingTasks.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(stateMutex);
+        taskAvailable.wait(lock, [this] { return stopping || queuedTasks.load() > 0; });
+        if (stopping && queuedTasks.load() == 0) {
+            return;
+        }
+    }
+}